@@ -0,0 +1,109 @@
+#include "heap_usage.h"
+
+#include <atomic>
+#include <cerrno>
+
+#include <malloc.h>
+
+// the allocator of glibc behind the interposed functions below
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void *ptr);
+}
+
+static std::atomic<std::size_t> in_use_bytes{0};
+static std::atomic<std::size_t> peak_bytes{0};
+
+/**
+ * @brief   Accounts for an allocated block.
+ */
+static void *allocated(void *ptr) noexcept {
+    if (ptr == nullptr) {
+        return ptr;
+    }
+    auto const size = malloc_usable_size(ptr);
+    auto const bytes =
+        in_use_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = peak_bytes.load(std::memory_order_relaxed);
+    while (bytes > peak && !peak_bytes.compare_exchange_weak(
+                               peak, bytes, std::memory_order_relaxed)) {
+    }
+    return ptr;
+}
+
+/**
+ * @brief   Accounts for a block about to be freed.
+ */
+static void released(void *ptr) noexcept {
+    if (ptr != nullptr) {
+        in_use_bytes.fetch_sub(malloc_usable_size(ptr),
+                               std::memory_order_relaxed);
+    }
+}
+
+extern "C" {
+void *malloc(std::size_t size) noexcept {
+    return allocated(__libc_malloc(size));
+}
+
+void *calloc(std::size_t count, std::size_t size) noexcept {
+    return allocated(__libc_calloc(count, size));
+}
+
+void *realloc(void *ptr, std::size_t size) noexcept {
+    // the block may move, it is accounted for as freed and allocated again
+    released(ptr);
+    auto *const result = __libc_realloc(ptr, size);
+    if (result == nullptr && size > 0) {
+        // failed, the original block is still in use
+        allocated(ptr);
+        return nullptr;
+    }
+    return allocated(result);
+}
+
+void *memalign(std::size_t alignment, std::size_t size) noexcept {
+    return allocated(__libc_memalign(alignment, size));
+}
+
+void *aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    return allocated(__libc_memalign(alignment, size));
+}
+
+int posix_memalign(void **ptr, std::size_t alignment,
+                   std::size_t size) noexcept {
+    if (alignment % sizeof(void *) != 0 ||
+        (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    auto *const result = allocated(__libc_memalign(alignment, size));
+    if (result == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+void free(void *ptr) noexcept {
+    released(ptr);
+    __libc_free(ptr);
+}
+}
+
+namespace bench {
+    std::size_t heap_usage::in_use() noexcept {
+        return in_use_bytes.load(std::memory_order_relaxed);
+    }
+
+    std::size_t heap_usage::peak() noexcept {
+        return peak_bytes.load(std::memory_order_relaxed);
+    }
+
+    void heap_usage::reset_peak() noexcept {
+        peak_bytes.store(in_use_bytes.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+} // namespace bench
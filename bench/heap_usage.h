@@ -0,0 +1,32 @@
+#ifndef COVID_PI_BENCH_HEAP_USAGE_H
+#define COVID_PI_BENCH_HEAP_USAGE_H
+
+#include <cstddef>
+
+namespace bench {
+    /**
+     *  Tracks the heap bytes in use by the whole process and their peak. The
+     *  malloc family of glibc is interposed by heap_usage.cpp, which must be
+     *  linked into the benchmark, so every allocation counts: the parsers,
+     *  curl's buffers and the page stores alike.
+     */
+    class heap_usage final {
+      public:
+        /**
+         *  @brief  Returns the heap bytes currently in use.
+         */
+        [[nodiscard]] static std::size_t in_use() noexcept;
+
+        /**
+         *  @brief  Returns the most heap bytes in use since the last reset.
+         */
+        [[nodiscard]] static std::size_t peak() noexcept;
+
+        /**
+         *  @brief  Restarts the peak at the bytes currently in use.
+         */
+        static void reset_peak() noexcept;
+    };
+} // namespace bench
+
+#endif // COVID_PI_BENCH_HEAP_USAGE_H
@@ -0,0 +1,193 @@
+#include <include/io/history_file.h>
+#include <include/provider.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+
+/**
+ *  Appends a synthetic multi-month history to a history file and measures
+ *  the append, reopen and range scan throughput.
+ *
+ *  Every refresh changes each location with the same probability, so a
+ *  location is updated `changes` times a day on average, just like a
+ *  provider which publishes a few times a day polled every `interval`.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+/**
+ * @brief   Returns the seconds elapsed since a point in time.
+ */
+static double seconds_since(bench_clock::time_point start) noexcept {
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/**
+ * @brief   Returns the size of a file, 0 if it does not exist.
+ */
+static std::uint64_t file_size(std::string const &path) noexcept {
+    struct stat st {};
+    return ::stat(path.c_str(), &st) == 0
+               ? static_cast<std::uint64_t>(st.st_size)
+               : 0;
+}
+
+int main(int argc, char *argv[]) {
+    std::string path{"history-bench.history"};
+    std::size_t locations{20000};
+    std::int64_t interval{20 * 60};
+    std::int64_t days{90};
+    double changes{4.0};
+
+    try {
+        cxxopts::Options options(argv[0],
+                                 "Benchmarks the history file on a synthetic "
+                                 "multi-month dataset.");
+        // clang-format off
+        options.add_options()
+            ("h, help", "Print usage")
+            ("path", "History file to be written, replaced if it exists (default: history-bench.history).", cxxopts::value<std::string>(), "path")
+            ("locations", "Number of locations (default: 20000).", cxxopts::value<std::size_t>(), "count")
+            ("interval", "Seconds between two refreshes (default: 1200).", cxxopts::value<std::int64_t>(), "seconds")
+            ("days", "Days of history (default: 90).", cxxopts::value<std::int64_t>(), "count")
+            ("changes", "Updates per location and day (default: 4).", cxxopts::value<double>(), "count");
+        // clang-format on
+        auto const result = options.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}\n", options.help());
+            return EXIT_SUCCESS;
+        }
+        if (result.count("path")) {
+            path = result["path"].as<std::string>();
+        }
+        if (result.count("locations")) {
+            locations = result["locations"].as<std::size_t>();
+        }
+        if (result.count("interval")) {
+            interval = result["interval"].as<std::int64_t>();
+        }
+        if (result.count("days")) {
+            days = result["days"].as<std::int64_t>();
+        }
+        if (result.count("changes")) {
+            changes = result["changes"].as<double>();
+        }
+    } catch (cxxopts::OptionException const &e) {
+        fmt::print(stderr, "Error parsing options: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+    if (locations == 0 || interval <= 0 || days <= 0) {
+        fmt::print(stderr, "Nothing to benchmark\n");
+        return EXIT_FAILURE;
+    }
+
+    auto const index_path = path + ".idx";
+    ::unlink(path.c_str());
+    ::unlink(index_path.c_str());
+
+    std::vector<std::string> names(locations);
+    std::vector<std::uint16_t> codes(locations);
+    std::vector<history::sample> samples(locations,
+                                         history::sample{0, 1000, 10, 500});
+    for (std::size_t i = 0; i < locations; ++i) {
+        names[i] = fmt::format("City {}", i);
+        codes[i] = utils::intern_alpha_2(i % 2 == 0 ? "de" : "us");
+    }
+
+    io::history_file file{};
+    if (!file.open(path, APIType::Cities, "")) {
+        return EXIT_FAILURE;
+    }
+    std::mt19937 rng{1};
+    std::bernoulli_distribution changed{
+        std::min(1.0, changes * static_cast<double>(interval) / 86400.0)};
+    std::vector<std::size_t> batch{};
+    batch.reserve(locations);
+    std::int64_t time{1590000000};
+    auto const refreshes = days * 86400 / interval;
+    std::uint64_t appended{0};
+    double append_seconds{0};
+    for (std::int64_t refresh = 0; refresh < refreshes; ++refresh) {
+        time += interval;
+        batch.clear();
+        for (std::size_t i = 0; i < locations; ++i) {
+            if (changed(rng)) {
+                auto &sample = samples[i];
+                sample.time = time - static_cast<std::int64_t>(rng() % 600);
+                sample.confirmed += static_cast<std::int32_t>(rng() % 200);
+                sample.dead += static_cast<std::int32_t>(rng() % 3);
+                sample.recovered += static_cast<std::int32_t>(rng() % 150);
+                batch.push_back(i);
+            }
+        }
+        // only the append itself is timed, not generating the samples
+        auto const start = bench_clock::now();
+        file.begin(time);
+        for (auto const i : batch) {
+            file.add(codes[i], names[i], samples[i]);
+        }
+        if (!file.commit()) {
+            return EXIT_FAILURE;
+        }
+        append_seconds += seconds_since(start);
+        appended += batch.size();
+    }
+
+    auto const size = file_size(path);
+    auto const index_size = file_size(index_path);
+    fmt::print("{} locations, {} refreshes, {} samples: {:.1f} MB + "
+               "{:.1f} KB index, {:.2f} bytes/sample\n",
+               locations, refreshes, appended,
+               static_cast<double>(size) / 1e6,
+               static_cast<double>(index_size) / 1e3,
+               static_cast<double>(size) / static_cast<double>(appended));
+    fmt::print("append: {:.2f} M samples/s, {:.1f} us/refresh\n",
+               static_cast<double>(appended) / append_seconds / 1e6,
+               append_seconds / static_cast<double>(refreshes) * 1e6);
+
+    auto start = bench_clock::now();
+    io::history_file reopened{};
+    if (!reopened.open(path, APIType::Cities, "")) {
+        return EXIT_FAILURE;
+    }
+    fmt::print("reopen: {:.2f} ms\n", seconds_since(start) * 1e3);
+
+    auto const scan = [&reopened](char const *name, std::int64_t from,
+                                  std::int64_t to) {
+        std::uint64_t count{0};
+        std::int64_t checksum{0};
+        auto const scan_start = bench_clock::now();
+        if (!reopened.scan(from, to, [&](auto, auto, auto const &sample) {
+                ++count;
+                checksum += sample.confirmed;
+            })) {
+            return false;
+        }
+        auto const elapsed = seconds_since(scan_start);
+        fmt::print("{}: {} samples in {:.2f} ms, {:.2f} M samples/s "
+                   "(checksum {})\n",
+                   name, count, elapsed * 1e3,
+                   static_cast<double>(count) / elapsed / 1e6, checksum);
+        return true;
+    };
+    if (!scan("full scan", std::numeric_limits<std::int64_t>::min(),
+              std::numeric_limits<std::int64_t>::max()) ||
+        !scan("last week", time - 7 * 86400, time + 1) ||
+        !scan("last day", time - 86400, time + 1)) {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
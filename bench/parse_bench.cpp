@@ -0,0 +1,177 @@
+#include "heap_usage.h"
+#include "replay.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <wiringPi.h>
+
+/**
+ *  Parses the same replayed response with several parse modes, e.g. the
+ *  streaming ingestion or the SAX handler against buffering the body and
+ *  building a DOM, and compares their parse time and allocations.
+ *
+ *  Each parse mode gets a pipeline of its own. Its first refresh grows the
+ *  arenas and buffers and is reported separately, the medians are taken
+ *  over the following warm refreshes. The stream mode parses while the body
+ *  is received, its parse time is the time spent in the parser.
+ *
+ *  parse-bench-scalar is the same benchmark built without SIMD, running
+ *  both on the same fixture shows the gain of the SIMD parser.
+ *
+ *  The peak heap is the most memory a refresh allocated on top of what was
+ *  in use before it, the pages published by the previous refresh included.
+ */
+
+/**
+ * @brief   Returns the median of some values, sorting them.
+ */
+static double median(std::vector<double> &values) noexcept {
+    std::sort(std::begin(values), std::end(values));
+    return values[values.size() / 2];
+}
+
+int main(int argc, char *argv[]) {
+    std::string fixture;
+    std::size_t synthetic{0};
+    APIType api_mode{APIType::Cities};
+    std::string parsers{"dom,sax,stream"};
+    std::size_t iterations{10};
+    bool validate{true};
+
+    try {
+        cxxopts::Options options(argv[0],
+                                 "Compares the parse modes on a replayed "
+                                 "response.");
+        // clang-format off
+        options.add_options()
+            ("h, help", "Print usage")
+            ("fixture", "Recorded response to be replayed.", cxxopts::value<std::string>(), "path")
+            ("synthetic", "Replay a generated cities response with this many records instead.", cxxopts::value<std::size_t>(), "count")
+            ("countries", "The fixture is a countries response.")
+            ("parsers", "Comma separated parse modes (default: dom,sax,stream).", cxxopts::value<std::string>(), "dom,sax,stream,parallel")
+            ("iterations", "Refreshes per parse mode, the first one warms up (default: 10).", cxxopts::value<std::size_t>(), "count")
+            ("no-validate", "Do not validate the response against the schema of its provider.");
+        // clang-format on
+        auto const result = options.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}\n", options.help());
+            return EXIT_SUCCESS;
+        }
+        if (result.count("fixture")) {
+            fixture = result["fixture"].as<std::string>();
+        }
+        if (result.count("synthetic")) {
+            synthetic = result["synthetic"].as<std::size_t>();
+        }
+        if (result.count("countries")) {
+            api_mode = APIType::Countries;
+        }
+        if (result.count("parsers")) {
+            parsers = result["parsers"].as<std::string>();
+        }
+        if (result.count("iterations")) {
+            iterations = result["iterations"].as<std::size_t>();
+        }
+        validate = result.count("no-validate") == 0;
+    } catch (cxxopts::OptionException const &e) {
+        fmt::print(stderr, "Error parsing options: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::pair<std::string_view, ParseMode>> modes{};
+    std::string_view remaining{parsers};
+    while (!remaining.empty()) {
+        auto const comma = std::min(remaining.find(','), remaining.size());
+        auto const name = remaining.substr(0, comma);
+        ParseMode mode{};
+        if (!bench::parse_mode_from(name, mode)) {
+            fmt::print(stderr, "Unknown parser: {}\n", name);
+            return EXIT_FAILURE;
+        }
+        modes.emplace_back(name, mode);
+        remaining.remove_prefix(std::min(comma + 1, remaining.size()));
+    }
+
+    auto const body = synthetic > 0 ? bench::synthetic_response(synthetic)
+                      : fixture.empty() ? std::string{}
+                                        : bench::read_fixture(fixture);
+    if (body.empty() || modes.empty() || iterations < 2) {
+        fmt::print(stderr, "Nothing to parse, pass --fixture or --synthetic, "
+                           "a parser and at least 2 iterations\n");
+        return EXIT_FAILURE;
+    }
+
+    // the refresh blinks the status LEDs
+    if (wiringPiSetup() != 0) {
+        fmt::print(stderr, "Unable to setup wiringPi: {}\n",
+                   std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    bench::replay_server server{body, std::chrono::milliseconds{0}, 0, 0};
+    if (!server.start()) {
+        return EXIT_FAILURE;
+    }
+
+    fmt::print("{} bytes, {} refreshes per parse mode, {} JSON parser, {}\n",
+               server.max_body_size(), iterations,
+               bench::simd_instruction_set(),
+               validate ? "validated" : "not validated");
+    for (auto &&[name, mode] : modes) {
+        // a pipeline of its own, so every mode warms up from scratch
+        auto pipeline = std::make_unique<bench::pipeline>(server, api_mode,
+                                                          mode, validate);
+        if (!pipeline->setup()) {
+            return EXIT_FAILURE;
+        }
+        std::vector<double> parses{};
+        std::vector<double> refreshes{};
+        double first_parse{0};
+        std::uint64_t first_allocations{0};
+        std::uint64_t allocations{0};
+        std::size_t first_peak{0};
+        std::size_t peak{0};
+        for (std::size_t i = 0; i < iterations; ++i) {
+            bench::heap_usage::reset_peak();
+            auto const heap_before = bench::heap_usage::in_use();
+            auto const start = bench::bench_clock::now();
+            if (!pipeline->handler.async_request()) {
+                fmt::print(stderr, "{}: refresh {} failed\n", name, i);
+                return EXIT_FAILURE;
+            }
+            auto const refresh = bench::milliseconds_since(start);
+            auto const heap = bench::heap_usage::peak() - heap_before;
+            auto const stats = pipeline->handler.stats();
+            auto const parse =
+                static_cast<double>(stats.last_timings.parse.count()) / 1e3;
+            if (i == 0) {
+                first_parse = parse;
+                first_allocations = stats.last_parse_allocations;
+                first_peak = heap;
+                continue;
+            }
+            parses.push_back(parse);
+            refreshes.push_back(refresh);
+            allocations = std::max(allocations, stats.last_parse_allocations);
+            peak = std::max(peak, heap);
+        }
+        auto const pages = pipeline->menu.pages();
+        fmt::print("{:>8}: {} records, parse {:.2f} ms (cold {:.2f} ms), "
+                   "refresh {:.2f} ms, allocations {} (cold {}), "
+                   "peak heap {} KB (cold {} KB)\n",
+                   name, pages != nullptr ? pages->size() : 0,
+                   median(parses), first_parse, median(refreshes),
+                   allocations, first_allocations, peak / 1024,
+                   first_peak / 1024);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,246 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+namespace bench {
+    replay_server::replay_server(std::string body,
+                                 std::chrono::milliseconds latency,
+                                 std::int64_t bandwidth,
+                                 std::size_t chunk_size)
+        : body_(std::move(body)), latency_(latency), bandwidth_(bandwidth),
+          chunk_size_(chunk_size) {
+        body_.push_back('\n');
+    }
+
+    replay_server::~replay_server() {
+        stop_.store(true);
+        // wakes up a blocking accept() or recv()
+        if (listen_fd_ >= 0) {
+            ::shutdown(listen_fd_, SHUT_RDWR);
+        }
+        auto const fd = connection_fd_.load();
+        if (fd >= 0) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (listen_fd_ >= 0) {
+            ::close(listen_fd_);
+        }
+    }
+
+    bool replay_server::start() {
+        listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        if (listen_fd_ < 0 ||
+            ::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address),
+                   length) != 0 ||
+            ::listen(listen_fd_, 1) != 0 ||
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&address),
+                          &length) != 0) {
+            fmt::print(stderr, "Unable to start the replay server: {}\n",
+                       std::strerror(errno));
+            return false;
+        }
+        port_ = ntohs(address.sin_port);
+        thread_ = std::thread{[this]() { serve(); }};
+        return true;
+    }
+
+    std::string replay_server::url() const {
+        return fmt::format("http://127.0.0.1:{}/", port_);
+    }
+
+    std::size_t replay_server::max_body_size() const noexcept {
+        return body_.size();
+    }
+
+    void replay_server::serve() {
+        while (!stop_.load()) {
+            auto const fd = ::accept(listen_fd_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            int const on{1};
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            connection_fd_.store(fd);
+            // the connection is kept alive, as curl reuses it
+            while (!stop_.load() && read_request(fd) && respond(fd)) {
+            }
+            connection_fd_.store(-1);
+            ::close(fd);
+        }
+    }
+
+    bool replay_server::read_request(int fd) {
+        request_.clear();
+        char buffer[4096];
+        while (request_.find("\r\n\r\n") == std::string::npos) {
+            auto const received = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) {
+                return false;
+            }
+            request_.append(buffer, static_cast<std::size_t>(received));
+        }
+        return true;
+    }
+
+    bool replay_server::respond(int fd) {
+        std::this_thread::sleep_for(latency_);
+        auto const size = body_.size() - (responses_++ % 2 == 0 ? 1 : 0);
+        auto const head =
+            chunk_size_ > 0
+                ? std::string{"HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Transfer-Encoding: chunked\r\n\r\n"}
+                : fmt::format("HTTP/1.1 200 OK\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: {}\r\n\r\n",
+                              size);
+        start_ = bench_clock::now();
+        sent_ = 0;
+        if (!send_paced(fd, head.data(), head.size())) {
+            return false;
+        }
+        if (chunk_size_ == 0) {
+            return send_paced(fd, body_.data(), size);
+        }
+        for (std::size_t offset = 0; offset < size; offset += chunk_size_) {
+            auto const length = std::min(chunk_size_, size - offset);
+            auto const frame = fmt::format("{:x}\r\n", length);
+            if (!send_paced(fd, frame.data(), frame.size()) ||
+                !send_paced(fd, body_.data() + offset, length) ||
+                !send_paced(fd, "\r\n", 2)) {
+                return false;
+            }
+        }
+        return send_paced(fd, "0\r\n\r\n", 5);
+    }
+
+    bool replay_server::send_paced(int fd, char const *data,
+                                   std::size_t size) {
+        constexpr std::size_t piece_size = 16 * 1024;
+        while (size > 0) {
+            auto const piece = std::min(size, piece_size);
+            auto const sent = ::send(fd, data, piece, MSG_NOSIGNAL);
+            if (sent <= 0) {
+                return false;
+            }
+            auto const count = static_cast<std::size_t>(sent);
+            data += count;
+            size -= count;
+            sent_ += count;
+            if (bandwidth_ > 0) {
+                std::this_thread::sleep_until(
+                    start_ + std::chrono::microseconds{
+                                 static_cast<std::int64_t>(sent_) * 1000000 /
+                                 bandwidth_});
+            }
+        }
+        return true;
+    }
+
+    pipeline::pipeline(replay_server const &server, APIType api_type,
+                       ParseMode parse_mode, bool validate)
+        : handler(menu, input_handler, fetcher, "",
+                  [](auto &&lhs, auto &&rhs) noexcept -> bool {
+                      return lhs.confirmed() > rhs.confirmed();
+                  }) {
+        handler.set_mode(api_type);
+        handler.set_url(server.url());
+        handler.set_parse_mode(parse_mode);
+        handler.set_validation(validate);
+        // large synthetic responses must not be cut off
+        handler.set_max_body_size(server.max_body_size());
+    }
+
+    bool pipeline::setup() {
+        if (!handler.setup()) {
+            fmt::print(stderr, "curl setup failed!\n");
+            return false;
+        }
+        handler.set_timeout(60L);
+        return true;
+    }
+
+    std::string synthetic_response(std::size_t records) {
+        static constexpr std::array<char const *, 6> codes{"de", "us", "fr",
+                                                           "it", "jp", "br"};
+        std::mt19937 rng{1};
+        fmt::memory_buffer out{};
+        fmt::format_to(out, "{{\"code\": 200, \"data\": [");
+        for (std::size_t i = 0; i < records; ++i) {
+            fmt::format_to(
+                out,
+                "{}{{\"location\": \"City {}\", \"country_code\": \"{}\", "
+                "\"latitude\": {}, \"longitude\": {}, \"confirmed\": {}, "
+                "\"dead\": {}, \"recovered\": {}, "
+                "\"updated\": \"2020-05-19 07:{:02}:{:02}.108706+00:00\"}}",
+                i == 0 ? "" : ", ", i, codes[rng() % codes.size()],
+                static_cast<double>(rng() % 180000) / 1000.0 - 90.0,
+                static_cast<double>(rng() % 360000) / 1000.0 - 180.0,
+                rng() % 1000000, rng() % 10000, rng() % 100000, rng() % 60,
+                rng() % 60);
+        }
+        fmt::format_to(out, "]}}");
+        return fmt::to_string(out);
+    }
+
+    std::string read_fixture(std::string const &path) {
+        std::ifstream in{path, std::ios::binary};
+        std::ostringstream contents{};
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    bool parse_mode_from(std::string_view name, ParseMode &mode) noexcept {
+        if (name == "dom") {
+            mode = ParseMode::Dom;
+        } else if (name == "sax") {
+            mode = ParseMode::Sax;
+        } else if (name == "stream") {
+            mode = ParseMode::Stream;
+        } else if (name == "parallel") {
+            mode = ParseMode::Parallel;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    char const *simd_instruction_set() noexcept {
+#if defined(RAPIDJSON_NEON)
+        return "NEON";
+#elif defined(RAPIDJSON_SSE42)
+        return "SSE4.2";
+#elif defined(RAPIDJSON_SSE2)
+        return "SSE2";
+#else
+        return "scalar";
+#endif
+    }
+
+    double milliseconds_since(bench_clock::time_point start) noexcept {
+        return std::chrono::duration<double, std::milli>(bench_clock::now() -
+                                                         start)
+            .count();
+    }
+} // namespace bench
@@ -0,0 +1,171 @@
+#ifndef COVID_PI_BENCH_REPLAY_H
+#define COVID_PI_BENCH_REPLAY_H
+
+#include <include/covid_status_handler.h>
+#include <include/io/input_handler.h>
+#include <include/io/menu.h>
+#include <include/net/fetcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace bench {
+    using bench_clock = std::chrono::steady_clock;
+
+    /**
+     *  A single-threaded HTTP/1.1 server which replays a response body with a
+     *  configurable latency, bandwidth and chunking.
+     *
+     *  It appends a newline to every other response. The records stay the
+     *  same, but no refresh is short-circuited as unchanged, so each one
+     *  parses the whole body.
+     */
+    class replay_server final {
+      public:
+        /**
+         *  @brief  Constructor.
+         *  @param  body        The response body, without the newline.
+         *  @param  latency     Delay between a request and its response
+         *                      headers.
+         *  @param  bandwidth   Send rate in bytes per second, 0 for
+         *                      unlimited.
+         *  @param  chunk_size  Size of the chunks of a chunked transfer
+         *                      encoding, 0 to send a Content-Length instead.
+         */
+        replay_server(std::string body, std::chrono::milliseconds latency,
+                      std::int64_t bandwidth, std::size_t chunk_size);
+
+        /**
+         *  @brief  Destructor, stops the server.
+         */
+        ~replay_server();
+
+        replay_server(replay_server const &) = delete;
+        replay_server &operator=(replay_server const &) = delete;
+
+        /**
+         *  @brief  Listens on an ephemeral port of the loopback interface.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool start();
+
+        /**
+         *  @brief  Returns the URL the body is served from.
+         */
+        [[nodiscard]] std::string url() const;
+
+        /**
+         *  @brief  Returns the size of the largest response body.
+         */
+        [[nodiscard]] std::size_t max_body_size() const noexcept;
+
+      private:
+        /**
+         *  @brief  Serves the connections one after the other until stopped.
+         */
+        void serve();
+
+        /**
+         *  @brief  Reads the head of a request, which is ignored.
+         *  @return False if the connection was closed, otherwise true.
+         */
+        bool read_request(int fd);
+
+        /**
+         *  @brief  Sends a response, paced to the bandwidth.
+         *  @return False if the connection was closed, otherwise true.
+         */
+        bool respond(int fd);
+
+        /**
+         *  @brief  Sends data, no faster than the bandwidth since the
+         *          response started.
+         */
+        bool send_paced(int fd, char const *data, std::size_t size);
+
+      private:
+        // the larger of the two replayed bodies, the other one lacks the
+        // trailing newline
+        std::string body_;
+        std::chrono::milliseconds latency_;
+        std::int64_t bandwidth_;
+        std::size_t chunk_size_;
+        int listen_fd_{-1};
+        std::atomic<int> connection_fd_{-1};
+        std::atomic<bool> stop_{false};
+        std::uint16_t port_{0};
+        std::thread thread_;
+        std::string request_;
+        std::uint64_t responses_{0};
+        bench_clock::time_point start_{};
+        std::size_t sent_{0};
+    };
+
+    /**
+     *  The refresh pipeline of covid-pi pointed at a replay server: the menu,
+     *  the input handler, which is not started, the fetcher and the handler.
+     */
+    struct pipeline final {
+        /**
+         *  @brief  Constructor.
+         *  @param  server      The server to fetch from, must be started.
+         *  @param  api_type    The API of the replayed response.
+         *  @param  parse_mode  The JSON parsing mode.
+         *  @param  validate    Whether to validate the response against the
+         *                      schema of its provider.
+         */
+        pipeline(replay_server const &server, APIType api_type,
+                 ParseMode parse_mode, bool validate);
+
+        pipeline(pipeline const &) = delete;
+        pipeline &operator=(pipeline const &) = delete;
+
+        /**
+         *  @brief  Sets up the transfers.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool setup();
+
+        io::menu menu{};
+        io::input_handler input_handler{menu};
+        net::fetcher fetcher{};
+        covid_status_handler handler;
+    };
+
+    /**
+     * @brief   Generates a cities response with the given number of records.
+     */
+    [[nodiscard]] std::string synthetic_response(std::size_t records);
+
+    /**
+     * @brief   Reads a recorded response.
+     * @return  The response, empty if the file could not be read.
+     */
+    [[nodiscard]] std::string read_fixture(std::string const &path);
+
+    /**
+     * @brief   Looks up a parse mode by its command line name.
+     * @return  True if the name is known, otherwise false.
+     */
+    [[nodiscard]] bool parse_mode_from(std::string_view name,
+                                       ParseMode &mode) noexcept;
+
+    /**
+     * @brief   Returns the SIMD instruction set the JSON parser of the
+     *          pipeline was built with.
+     */
+    [[nodiscard]] char const *simd_instruction_set() noexcept;
+
+    /**
+     * @brief   Returns the milliseconds elapsed since a point in time.
+     */
+    [[nodiscard]] double
+    milliseconds_since(bench_clock::time_point start) noexcept;
+} // namespace bench
+
+#endif // COVID_PI_BENCH_REPLAY_H
@@ -0,0 +1,150 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <wiringPi.h>
+
+/**
+ *  Replays a recorded or synthetic response from a local stand-in server and
+ *  measures the refresh pipeline end to end: fetch, parse, sort and the hand
+ *  over to the menu.
+ */
+
+int main(int argc, char *argv[]) {
+    std::string fixture;
+    std::size_t synthetic{0};
+    APIType api_mode{APIType::Cities};
+    ParseMode parse_mode{ParseMode::Stream};
+    std::int64_t latency{0};
+    std::int64_t bandwidth{0};
+    std::size_t chunk_size{0};
+    std::size_t iterations{10};
+    bool validate{true};
+
+    try {
+        cxxopts::Options options(argv[0],
+                                 "Benchmarks the refresh pipeline against a "
+                                 "local replay server.");
+        // clang-format off
+        options.add_options()
+            ("h, help", "Print usage")
+            ("fixture", "Recorded response to be replayed.", cxxopts::value<std::string>(), "path")
+            ("synthetic", "Replay a generated cities response with this many records instead.", cxxopts::value<std::size_t>(), "count")
+            ("countries", "The fixture is a countries response.")
+            ("p, parser", "JSON parsing mode.", cxxopts::value<std::string>(), "dom / sax / stream / parallel")
+            ("latency", "Delay of each response (default: 0).", cxxopts::value<std::int64_t>(), "ms")
+            ("bandwidth", "Send rate of the server, 0 for unlimited (default: 0).", cxxopts::value<std::int64_t>(), "bytes/s")
+            ("chunk", "Send a chunked response with chunks of this size, 0 for a Content-Length (default: 0).", cxxopts::value<std::size_t>(), "bytes")
+            ("iterations", "Number of refreshes (default: 10).", cxxopts::value<std::size_t>(), "count")
+            ("no-validate", "Do not validate the response against the schema of its provider.");
+        // clang-format on
+        auto const result = options.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}\n", options.help());
+            return EXIT_SUCCESS;
+        }
+        if (result.count("fixture")) {
+            fixture = result["fixture"].as<std::string>();
+        }
+        if (result.count("synthetic")) {
+            synthetic = result["synthetic"].as<std::size_t>();
+        }
+        if (result.count("countries")) {
+            api_mode = APIType::Countries;
+        }
+        if (result.count("parser")) {
+            auto const mode = result["parser"].as<std::string>();
+            if (!bench::parse_mode_from(mode, parse_mode)) {
+                fmt::print(stderr, "Unknown parser: {}\n", mode);
+                return EXIT_FAILURE;
+            }
+        }
+        if (result.count("latency")) {
+            latency = result["latency"].as<std::int64_t>();
+        }
+        if (result.count("bandwidth")) {
+            bandwidth = result["bandwidth"].as<std::int64_t>();
+        }
+        if (result.count("chunk")) {
+            chunk_size = result["chunk"].as<std::size_t>();
+        }
+        if (result.count("iterations")) {
+            iterations = result["iterations"].as<std::size_t>();
+        }
+        validate = result.count("no-validate") == 0;
+    } catch (cxxopts::OptionException const &e) {
+        fmt::print(stderr, "Error parsing options: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    auto const body = synthetic > 0 ? bench::synthetic_response(synthetic)
+                      : fixture.empty() ? std::string{}
+                                        : bench::read_fixture(fixture);
+    if (body.empty() || iterations == 0) {
+        fmt::print(stderr, "Nothing to replay, pass --fixture or "
+                           "--synthetic\n");
+        return EXIT_FAILURE;
+    }
+
+    // the refresh blinks the status LEDs
+    if (wiringPiSetup() != 0) {
+        fmt::print(stderr, "Unable to setup wiringPi: {}\n",
+                   std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+    bench::replay_server server{body, std::chrono::milliseconds{latency},
+                                bandwidth, chunk_size};
+    if (!server.start()) {
+        return EXIT_FAILURE;
+    }
+    bench::pipeline pipeline{server, api_mode, parse_mode, validate};
+    if (!pipeline.setup()) {
+        return EXIT_FAILURE;
+    }
+
+    std::vector<double> refreshes{};
+    covid_status_handler::timings total{};
+    for (std::size_t i = 0; i < iterations; ++i) {
+        auto const start = bench::bench_clock::now();
+        if (!pipeline.handler.async_request()) {
+            fmt::print(stderr, "refresh {} failed\n", i);
+            return EXIT_FAILURE;
+        }
+        refreshes.push_back(bench::milliseconds_since(start));
+        auto const &t = pipeline.handler.stats().last_timings;
+        total.first_byte += t.first_byte;
+        total.total += t.total;
+        total.parse += t.parse;
+        total.sort += t.sort;
+        total.publish += t.publish;
+    }
+
+    auto const pages = pipeline.menu.pages();
+    auto const stats = pipeline.handler.stats();
+    fmt::print("{} bytes, {} records, {} refreshes ({} unchanged), {}\n",
+               server.max_body_size(), pages != nullptr ? pages->size() : 0,
+               iterations, stats.unchanged,
+               validate ? "validated" : "not validated");
+    std::sort(std::begin(refreshes), std::end(refreshes));
+    fmt::print("refresh: min {:.2f} ms, median {:.2f} ms, max {:.2f} ms\n",
+               refreshes.front(), refreshes[refreshes.size() / 2],
+               refreshes.back());
+    auto const mean = [iterations](std::chrono::microseconds value) {
+        return value.count() / static_cast<std::int64_t>(iterations);
+    };
+    fmt::print("mean: first byte {}us, transfer {}us, parse {}us, "
+               "sort {}us, publish {}us\n",
+               mean(total.first_byte), mean(total.total), mean(total.parse),
+               mean(total.sort), mean(total.publish));
+    fmt::print("last parse: {} allocations\n", stats.last_parse_allocations);
+    return EXIT_SUCCESS;
+}
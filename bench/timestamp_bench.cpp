@@ -0,0 +1,198 @@
+#include <include/utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <rapidjson/document.h>
+
+/**
+ *  Parses the "updated" timestamps of a recorded response, or generated ones
+ *  of the same layout, with utils::parse_timestamp() and with the generic
+ *  date parsers of the C and C++ library, strptime() and std::get_time(),
+ *  and compares their time per timestamp. All of them must agree.
+ *
+ *  The generic parsers only read the date and the time of the day, the
+ *  fraction and the UTC offset are skipped and read by the same sscanf()
+ *  for both of them.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+
+/**
+ * @brief   Returns the "updated" timestamps of a recorded response.
+ */
+static std::vector<std::string> fixture_timestamps(std::string const &path) {
+    std::ifstream in{path, std::ios::binary};
+    std::ostringstream contents{};
+    contents << in.rdbuf();
+    rapidjson::Document doc{};
+    doc.Parse(contents.str().c_str());
+    std::vector<std::string> timestamps{};
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("data") ||
+        !doc["data"].IsArray()) {
+        return timestamps;
+    }
+    for (auto const &record : doc["data"].GetArray()) {
+        if (record.IsObject() && record.HasMember("updated") &&
+            record["updated"].IsString()) {
+            timestamps.emplace_back(record["updated"].GetString());
+        }
+    }
+    return timestamps;
+}
+
+/**
+ * @brief   Returns timestamps of the layout used by the API, spread over a
+ *          few years and UTC offsets.
+ */
+static std::vector<std::string> synthetic_timestamps(std::size_t count) {
+    static constexpr char const *offsets[] = {"+00:00", "+00:00", "+02:00",
+                                              "-05:30"};
+    std::mt19937 rng{1};
+    std::vector<std::string> timestamps(count);
+    for (auto &timestamp : timestamps) {
+        timestamp = fmt::format(
+            "{}-{:02}-{:02} {:02}:{:02}:{:02}.{:06}{}", 2020 + rng() % 3,
+            1 + rng() % 12, 1 + rng() % 28, rng() % 24, rng() % 60,
+            rng() % 60, rng() % 1000000, offsets[rng() % 4]);
+    }
+    return timestamps;
+}
+
+/**
+ * @brief   Returns the UTC offset in seconds of what follows the time of the
+ *          day, an optional fraction and an optional "+HH:MM".
+ */
+static std::int64_t utc_offset(char const *rest) noexcept {
+    char sign{'+'};
+    int hours{0};
+    int minutes{0};
+    if (std::sscanf(rest, "%*[.0-9]%c%2d:%2d", &sign, &hours, &minutes) !=
+            3 &&
+        std::sscanf(rest, "%c%2d:%2d", &sign, &hours, &minutes) != 3) {
+        return 0;
+    }
+    auto const offset = (hours * 60 + minutes) * 60;
+    return sign == '-' ? -offset : offset;
+}
+
+/**
+ * @brief   Parses a timestamp with strptime() and timegm().
+ */
+static std::int64_t parse_strptime(std::string const &str) noexcept {
+    std::tm tm{};
+    auto const *const rest = ::strptime(str.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
+    if (rest == nullptr) {
+        return 0;
+    }
+    return static_cast<std::int64_t>(::timegm(&tm)) - utc_offset(rest);
+}
+
+/**
+ * @brief   Parses a timestamp with std::get_time() and timegm().
+ */
+static std::int64_t parse_get_time(std::string const &str) {
+    std::istringstream in{str};
+    std::tm tm{};
+    in >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    if (in.fail()) {
+        return 0;
+    }
+    auto const consumed = static_cast<std::size_t>(in.tellg());
+    return static_cast<std::int64_t>(::timegm(&tm)) -
+           utc_offset(str.c_str() + consumed);
+}
+
+int main(int argc, char *argv[]) {
+    std::string fixture;
+    std::size_t count{100000};
+    std::size_t iterations{10};
+
+    try {
+        cxxopts::Options options(argv[0],
+                                 "Compares parse_timestamp() with the generic "
+                                 "date parsers.");
+        // clang-format off
+        options.add_options()
+            ("h, help", "Print usage")
+            ("fixture", "Recorded response whose timestamps are parsed.", cxxopts::value<std::string>(), "path")
+            ("count", "Number of generated timestamps without a fixture (default: 100000).", cxxopts::value<std::size_t>(), "count")
+            ("iterations", "Passes over all timestamps per parser (default: 10).", cxxopts::value<std::size_t>(), "count");
+        // clang-format on
+        auto const result = options.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}\n", options.help());
+            return EXIT_SUCCESS;
+        }
+        if (result.count("fixture")) {
+            fixture = result["fixture"].as<std::string>();
+        }
+        if (result.count("count")) {
+            count = result["count"].as<std::size_t>();
+        }
+        if (result.count("iterations")) {
+            iterations = result["iterations"].as<std::size_t>();
+        }
+    } catch (cxxopts::OptionException const &e) {
+        fmt::print(stderr, "Error parsing options: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    auto const timestamps = fixture.empty() ? synthetic_timestamps(count)
+                                            : fixture_timestamps(fixture);
+    if (timestamps.empty() || iterations == 0) {
+        fmt::print(stderr, "Nothing to parse\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::int64_t> expected(timestamps.size());
+    std::transform(std::begin(timestamps), std::end(timestamps),
+                   std::begin(expected),
+                   [](auto const &str) { return utils::parse_timestamp(str); });
+
+    fmt::print("{} timestamps, {} passes per parser\n", timestamps.size(),
+               iterations);
+    auto const run = [&](char const *name, auto &&parse) {
+        std::vector<double> passes{};
+        std::size_t mismatches{0};
+        for (std::size_t i = 0; i < iterations; ++i) {
+            mismatches = 0;
+            auto const start = bench_clock::now();
+            for (std::size_t j = 0; j < timestamps.size(); ++j) {
+                if (parse(timestamps[j]) != expected[j]) {
+                    ++mismatches;
+                }
+            }
+            passes.push_back(
+                std::chrono::duration<double, std::nano>(bench_clock::now() -
+                                                         start)
+                    .count() /
+                static_cast<double>(timestamps.size()));
+        }
+        std::sort(std::begin(passes), std::end(passes));
+        fmt::print("{:>16}: median {:.1f} ns, min {:.1f} ns per timestamp, "
+                   "{} mismatches\n",
+                   name, passes[passes.size() / 2], passes.front(),
+                   mismatches);
+        return mismatches == 0;
+    };
+    // every parser runs, even if an earlier one disagreed
+    auto const own = run("parse_timestamp", [](auto const &str) {
+        return utils::parse_timestamp(str);
+    });
+    auto const c = run("strptime", parse_strptime);
+    auto const cpp = run("std::get_time", parse_get_time);
+    return own && c && cpp ? EXIT_SUCCESS : EXIT_FAILURE;
+}
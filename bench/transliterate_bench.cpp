@@ -0,0 +1,205 @@
+#include <include/json/covid_data.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cxxopts.hpp>
+#include <fmt/format.h>
+#include <rapidjson/document.h>
+
+/**
+ *  Copies the location names of a recorded response into the fixed-size
+ *  name of a record, once with utils::copy_name() and its single pass
+ *  transliteration, once with each of the umlaut replacements it replaced,
+ *  and compares their time per name.
+ *
+ *  The replacements are local copies of the removed code: the unordered_map
+ *  of the first version and the linear search which followed it.
+ */
+
+using bench_clock = std::chrono::steady_clock;
+using name_type = std::array<char, MAX_COUNTRY_NAME_LEN + 1>;
+
+/**
+ * @brief   Returns the location names of a recorded response.
+ */
+static std::vector<std::string> fixture_names(std::string const &path) {
+    std::ifstream in{path, std::ios::binary};
+    std::ostringstream contents{};
+    contents << in.rdbuf();
+    rapidjson::Document doc{};
+    doc.Parse(contents.str().c_str());
+    std::vector<std::string> names{};
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("data") ||
+        !doc["data"].IsArray()) {
+        return names;
+    }
+    for (auto const &record : doc["data"].GetArray()) {
+        if (record.IsObject() && record.HasMember("location") &&
+            record["location"].IsString()) {
+            names.emplace_back(record["location"].GetString(),
+                               record["location"].GetStringLength());
+        }
+    }
+    return names;
+}
+
+/**
+ * @brief   The first umlaut replacement, searching the whole string for every
+ *          umlaut once per character.
+ */
+static void map_replace_umlauts(std::string &str) {
+    std::unordered_map<std::string, std::string> static const umlauts{
+        {"ä", "ae"}, {"ö", "oe"}, {"ü", "ue"}, {"Ä", "Ae"},
+        {"Ö", "Oe"}, {"Ü", "Ue"}, {"ß", "ss"}};
+
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        for (auto const &[k, v] : umlauts) {
+            auto pos = str.find(k);
+            if (pos != std::string::npos) {
+                str[pos] = v[0];
+                str[pos + 1] = v[1];
+            }
+        }
+    }
+}
+
+/**
+ * @brief   The umlaut replacement which followed it, one linear search per
+ *          umlaut.
+ */
+static void linear_replace_umlauts(char *str, std::size_t size) {
+    constexpr std::array<std::pair<std::string_view, std::string_view>, 7>
+        umlauts{{{"ä", "ae"},
+                 {"ö", "oe"},
+                 {"ü", "ue"},
+                 {"Ä", "Ae"},
+                 {"Ö", "Oe"},
+                 {"Ü", "Ue"},
+                 {"ß", "ss"}}};
+
+    std::string_view const view{str, size};
+    for (auto const &[k, v] : umlauts) {
+        for (auto pos = view.find(k); pos != std::string_view::npos;
+             pos = view.find(k, pos + k.size())) {
+            str[pos] = v[0];
+            str[pos + 1] = v[1];
+        }
+    }
+}
+
+/**
+ * @brief   Copies a name the way the first version did, replacing the
+ *          umlauts of a copy of the whole location.
+ */
+static void map_copy_name(std::string_view location, name_type &name) {
+    std::string str{location};
+    map_replace_umlauts(str);
+    auto const length = std::min(str.size(), name.size() - 1);
+    std::copy_n(std::begin(str), length, std::begin(name));
+    name[length] = '\0';
+}
+
+/**
+ * @brief   Copies a name the way the linear replacement did, through a
+ *          buffer one byte larger than the name.
+ */
+static void linear_copy_name(std::string_view location, name_type &name) {
+    name_type buffer{};
+    auto const size = std::min(location.size(), buffer.size());
+    std::copy_n(std::begin(location), size, std::begin(buffer));
+    linear_replace_umlauts(buffer.data(), size);
+    auto const length = std::min(size, name.size() - 1);
+    std::copy_n(std::begin(buffer), length, std::begin(name));
+    name[length] = '\0';
+}
+
+int main(int argc, char *argv[]) {
+    std::string fixture;
+    std::size_t iterations{10};
+
+    try {
+        cxxopts::Options options(argv[0],
+                                 "Compares transliterate() with the umlaut "
+                                 "replacements it replaced.");
+        // clang-format off
+        options.add_options()
+            ("h, help", "Print usage")
+            ("fixture", "Recorded response whose location names are copied.", cxxopts::value<std::string>(), "path")
+            ("iterations", "Passes over all names per copy (default: 10).", cxxopts::value<std::size_t>(), "count");
+        // clang-format on
+        auto const result = options.parse(argc, argv);
+        if (result.count("help")) {
+            fmt::print("{}\n", options.help());
+            return EXIT_SUCCESS;
+        }
+        if (result.count("fixture")) {
+            fixture = result["fixture"].as<std::string>();
+        }
+        if (result.count("iterations")) {
+            iterations = result["iterations"].as<std::size_t>();
+        }
+    } catch (cxxopts::OptionException const &e) {
+        fmt::print(stderr, "Error parsing options: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+
+    auto const names = fixture.empty() ? std::vector<std::string>{}
+                                       : fixture_names(fixture);
+    if (names.empty() || iterations == 0) {
+        fmt::print(stderr, "Nothing to copy, pass --fixture\n");
+        return EXIT_FAILURE;
+    }
+    auto const non_ascii = std::count_if(
+        std::begin(names), std::end(names), [](auto const &name) {
+            return std::any_of(std::begin(name), std::end(name), [](char c) {
+                return static_cast<unsigned char>(c) >= 0x80;
+            });
+        });
+
+    fmt::print("{} names ({} not ASCII), {} passes per copy\n", names.size(),
+               non_ascii, iterations);
+    std::vector<name_type> copied(names.size());
+    auto const run = [&](char const *name, auto &&copy) {
+        std::vector<double> passes{};
+        for (std::size_t i = 0; i < iterations; ++i) {
+            auto const start = bench_clock::now();
+            for (std::size_t j = 0; j < names.size(); ++j) {
+                copy(names[j], copied[j]);
+            }
+            passes.push_back(
+                std::chrono::duration<double, std::nano>(bench_clock::now() -
+                                                         start)
+                    .count() /
+                static_cast<double>(names.size()));
+        }
+        std::sort(std::begin(passes), std::end(passes));
+        // the copies are checked, so none of them can be optimized away
+        std::uint64_t checksum{utils::FNV_OFFSET_BASIS};
+        for (auto const &copy_of_name : copied) {
+            checksum = utils::fnv1a(copy_of_name.data(),
+                                    std::strlen(copy_of_name.data()), checksum);
+        }
+        fmt::print("{:>16}: median {:.1f} ns, min {:.1f} ns per name "
+                   "(checksum {:016x})\n",
+                   name, passes[passes.size() / 2], passes.front(), checksum);
+    };
+    run("unordered_map", map_copy_name);
+    run("linear", linear_copy_name);
+    run("transliterate", [](std::string_view location, name_type &name) {
+        utils::copy_name(location, name);
+    });
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+function(enable_simd project_name)
+
+  option(ENABLE_SIMD "Enable SIMD accelerated JSON parsing" ON)
+  set(SIMD_INSTRUCTION_SET
+      ""
+      CACHE STRING
+            "SIMD instruction set of the JSON parser, detected if empty")
+  set_property(CACHE SIMD_INSTRUCTION_SET PROPERTY STRINGS "" "NEON" "SSE42"
+                                                   "SSE2" "NONE")
+
+  if(NOT ENABLE_SIMD)
+    message(STATUS "JSON parser SIMD: disabled")
+    return()
+  endif()
+
+  # cross builds select the instruction set in their toolchain file, host
+  # builds use the best one the compiler supports
+  set(INSTRUCTION_SET "${SIMD_INSTRUCTION_SET}")
+  if(INSTRUCTION_SET STREQUAL "")
+    if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64|i.86")
+      include(CheckCXXCompilerFlag)
+      check_cxx_compiler_flag(-msse4.2 HAS_SSE42)
+      if(HAS_SSE42)
+        set(INSTRUCTION_SET "SSE42")
+      else()
+        set(INSTRUCTION_SET "SSE2")
+      endif()
+    elseif(CMAKE_SYSTEM_PROCESSOR MATCHES "aarch64|arm64")
+      set(INSTRUCTION_SET "NEON")
+    else()
+      set(INSTRUCTION_SET "NONE")
+    endif()
+  endif()
+
+  if(INSTRUCTION_SET STREQUAL "SSE42")
+    target_compile_definitions(${project_name} INTERFACE RAPIDJSON_SSE42)
+    target_compile_options(${project_name} INTERFACE -msse4.2)
+  elseif(INSTRUCTION_SET STREQUAL "SSE2")
+    target_compile_definitions(${project_name} INTERFACE RAPIDJSON_SSE2)
+    target_compile_options(${project_name} INTERFACE -msse2)
+  elseif(INSTRUCTION_SET STREQUAL "NEON")
+    # -mfpu=neon-vfpv4 is part of the toolchain flags, implied on aarch64
+    target_compile_definitions(${project_name} INTERFACE RAPIDJSON_NEON)
+  elseif(NOT INSTRUCTION_SET STREQUAL "NONE")
+    message(
+      SEND_ERROR "Unknown SIMD instruction set '${INSTRUCTION_SET}'")
+  endif()
+
+  message(STATUS "JSON parser SIMD: ${INSTRUCTION_SET}")
+
+endfunction()
@@ -103,6 +103,13 @@ else()
 	set(CMAKE_CXX_FLAGS "${CMAKE_C_FLAGS}" CACHE STRING "Flags for Raspberry PI 1 B+ Zero")
 endif()
 
+# SIMD instruction set of the JSON parser, see cmake/Simd.cmake
+if(RASPBERRY_VERSION VERSION_GREATER 1)
+	set(SIMD_INSTRUCTION_SET "NEON" CACHE STRING "NEON for Raspberry PI 2/3/4")
+else()
+	set(SIMD_INSTRUCTION_SET "NONE" CACHE STRING "No NEON on the ARMv6 of Raspberry PI 1 B+ Zero")
+endif()
+
 set(CMAKE_FIND_ROOT_PATH "${CMAKE_INSTALL_PREFIX};${CMAKE_PREFIX_PATH};${CMAKE_SYSROOT}")
 
 
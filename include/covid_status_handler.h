@@ -1,53 +1,87 @@
 #ifndef COVID_PI_COVID_STATUS_HANDLER_H
 #define COVID_PI_COVID_STATUS_HANDLER_H
 
+#include "data_source.h"
+#include "history.h"
+#include "io/history_file.h"
 #include "io/menu.h"
 #include "io/input_handler.h"
+#include "movers.h"
+#include "net/fetcher.h"
+#include "provider.h"
 
-#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <string>
 #include <string_view>
+#include <vector>
 
-using CURL = void;
-
-// clang-format off
-enum APIType : std::uint8_t { 
-    Countries,
-    Cities
-};
-// clang-format on
-
+/**
+ *  Refreshes the pages from one or more providers. All providers are fetched
+ *  in parallel; whenever one of them delivers new records, the records of all
+ *  providers are merged by location and published, so a slow or unreachable
+ *  provider does not hold back the others.
+ */
 class covid_status_handler final {
   public:
     using SortFunction = std::function<bool(io::menu::page_type const &,
                                             io::menu::page_type const &)>;
 
-    static constexpr std::array<char const *, 2> apis{
-        "https://www.trackcorona.live/api/countries",
-        "https://www.trackcorona.live/api/cities"};
+    using timings = data_source::timings;
+    using statistics = data_source::statistics;
 
     /**
      *  @brief  Constructor.
      *  @param  menu  A menu reference.
      *  @param  input_handler  An input_handler reference.
+     *  @param  fetcher A fetcher reference which drives the transfers.
      *  @param  country An alpha-2-code country code.
      *  @param  sort_fun A sort function pointer.
      */
     explicit covid_status_handler(io::menu &menu,
                                   io::input_handler &input_handler,
+                                  net::fetcher &fetcher,
                                   std::string_view country,
                                   SortFunction &&sort_fun);
 
     /**
-     *  @brief  Destructor.
+     *  @brief  Specifies the API of the primary provider. Must be called
+     *          before the provider is configured.
+     *  @param  api_type    The API Type.
+     */
+    void set_mode(APIType api_type);
+
+    /**
+     *  @brief  Adds another provider whose records are merged into the ones
+     *          of the primary provider. The settings below apply to all
+     *          providers added so far.
+     *  @param  source  The provider.
      */
-    ~covid_status_handler();
+    void add_provider(provider source);
 
     /**
-     *  @brief  Specifies the API URL.
-     *  @param  api_type    The API Type.
+     *  @brief  Overrides the URL of the primary provider, e.g. to replay a
+     *          recorded response from a file:// URL or a local server.
+     *  @param  url The URL.
      */
-    void set_mode(APIType api_type) noexcept;
+    void set_url(std::string const &url) noexcept;
+
+    /**
+     *  @brief  Limits the receive rate of each provider to emulate a slow
+     *          connection.
+     *  @param  bytes_per_second    The rate limit, 0 for unlimited.
+     */
+    void set_max_recv_speed(std::int64_t bytes_per_second) noexcept;
+
+    /**
+     *  @brief  Sets the preferred size of the chunks handed to the write
+     *          callback.
+     *  @param  bytes   The chunk size, clamped by libcurl to 1KB..512KB.
+     */
+    void set_chunk_size(long bytes) noexcept;
 
     /**
      *  @brief  Sets the maximum timeout to wait for a request to finish.
@@ -57,36 +91,175 @@ class covid_status_handler final {
     void set_timeout(long timeout) noexcept;
 
     /**
-     *  @brief  Prepare the Curl Request.
+     *  @brief  Limits the response body size of each provider. Larger
+     *          responses are aborted, if possible before their body is
+     *          received.
+     *  @param  bytes   The maximum decoded body size.
+     */
+    void set_max_body_size(std::size_t bytes) noexcept;
+
+    /**
+     *  @brief  Specifies how the response bodies are parsed. Must be called
+     *          before setup().
+     *  @param  parse_mode  Dom buffers the whole body and parses it into a
+     *                      rapidjson::Document once received. Stream parses
+     *                      each record while the body is still arriving.
+     */
+    void set_parse_mode(ParseMode parse_mode) noexcept;
+
+    /**
+     *  @brief  Enables or disables the validation of the responses against
+     *          the schemas of their providers. Enabled by default.
+     *  @param  validate    Whether to validate.
+     */
+    void set_validation(bool validate);
+
+    /**
+     *  @brief  Specifies where the pages are persisted after each successful
+     *          refresh. An empty path disables snapshots.
+     *  @param  path    The snapshot file.
+     */
+    void set_snapshot_path(std::string path) noexcept;
+
+    /**
+     *  @brief  Sets the memory ceiling and depth of the per-location
+     *          history, which is preallocated right away.
+     *  @param  max_bytes   The memory ceiling, 0 disables the history.
+     *  @param  depth       The number of samples kept per location.
+     */
+    void set_history(std::size_t max_bytes, std::size_t depth);
+
+    /**
+     *  @brief  Specifies where the history is persisted. An empty path keeps
+     *          it in memory only.
+     *  @param  path    The history file.
+     */
+    void set_history_path(std::string path) noexcept;
+
+    /**
+     *  @brief  Opens the history file and refills the history from it, if
+     *          it belongs to the same API mode and country filter.
+     *  @return True if the history file is in use, otherwise false.
+     */
+    [[nodiscard]] bool restore_history();
+
+    /**
+     *  @brief  Sets the number of locations listed as movers, i.e. the ones
+     *          whose confirmed cases grew the most since the previous
+     *          refresh.
+     *  @param  count   The number of movers, 0 disables them.
+     */
+    void set_movers(std::size_t count);
+
+    /**
+     *  @brief  Publishes the pages of the last snapshot to the menu, if the
+     *          snapshot belongs to the same API mode and country filter.
+     *  @return True if a snapshot was restored, otherwise false.
+     */
+    [[nodiscard]] bool restore_snapshot();
+
+    /**
+     *  @brief  Prepare the Curl Requests.
      *  @return  True if successful, otherwise false.
      */
     [[nodiscard]] bool setup() noexcept;
 
     /**
-     *  @brief  Performs a blocking GET request.
-     *  @return True if successful, otherwise false.
+     *  @brief  Performs a blocking GET request on each provider, one after
+     *          the other.
+     *  @return True if any provider succeeded, otherwise false.
      */
     [[nodiscard]] bool request() noexcept;
 
     /**
-     *  @brief  Performs an async non-blocking GET request.
+     *  @brief  Queues a non-blocking GET request per provider on the fetcher.
+     *          The data of each provider is handled as soon as the fetcher has
+     *          completed its transfer.
      *  @return True if successful, otherwise false.
      */
+    [[nodiscard]] bool start_request();
+
+    /**
+     *  @brief  Queues the non-blocking GET requests and drives the fetcher
+     *          until all of its transfers have finished.
+     *  @return True if any provider succeeded, otherwise false.
+     */
     [[nodiscard]] bool async_request();
 
+    /**
+     *  @brief  Returns the counters of the short-circuited refresh cycles,
+     *          summed over all providers. The last transfer is the one of
+     *          the provider which finished last.
+     */
+    [[nodiscard]] statistics stats() const noexcept;
+
+    /**
+     *  @brief  Returns how long the last responses stay fresh according to
+     *          their Cache-Control max-age or Expires headers.
+     *  @return The shortest freshness lifetime or 0 if any server did not
+     *          specify one.
+     */
+    [[nodiscard]] std::chrono::seconds freshness() const noexcept;
+
+    /**
+     *  @brief  Determines whether the last request delivered new data, i.e.
+     *          any record of any provider has a newer "updated" timestamp
+     *          than before.
+     */
+    [[nodiscard]] bool data_changed() const noexcept;
+
   private:
     /**
-     *  @brief  The callback when the data was completely received.
+     *  @brief  Evaluates the finished transfer of a provider and publishes
+     *          the merged records if it delivered new ones.
+     *  @param  source  The provider whose transfer finished.
+     *  @param  ok  Whether the transfer itself succeeded.
      *  @return True if successful, otherwise false.
      */
-    [[nodiscard]] bool handle_data_received();
+    [[nodiscard]] bool handle_data_received(data_source &source, bool ok);
+
+    /**
+     *  @brief  Merges the records of all providers by location.
+     *  @return The merged records.
+     */
+    [[nodiscard]] io::menu::pages_type merge() const;
+
+    /**
+     *  @brief  Appends the records which changed since the previous refresh
+     *          to the history file, according to the last page diff.
+     *  @param  pages   The pages of the refresh.
+     *  @param  now     The seconds since the epoch of the refresh.
+     */
+    void append_history(io::menu::pages_type const &pages, std::int64_t now);
+
+    /**
+     *  @brief  Hands the sorted pages over to the menu and wakes up the input
+     *          handler thread.
+     *  @param  pages   The pages to be displayed.
+     */
+    void publish(io::menu::pages_type &&pages);
 
   private:
-    CURL *handle_;
-    std::string json_data_;
+    std::vector<std::unique_ptr<data_source>> sources_;
+    data_source const *last_source_{nullptr};
+    APIType api_type_{APIType::Countries};
+    std::string snapshot_path_;
+    history history_{};
+    std::string history_path_;
+    io::history_file history_file_;
+    // the page diff, which also tells the history file what changed
+    movers movers_{};
+    // sort and publish timings of the last merged page set
+    std::chrono::microseconds sort_time_{};
+    std::chrono::microseconds publish_time_{};
+
+    // transfers of the current refresh cycle which are still running
+    std::size_t pending_{0};
+    bool result_{false};
 
     io::menu &menu_;
     io::input_handler &input_handler_;
+    net::fetcher &fetcher_;
 
     std::string_view country_;
     SortFunction sort_fun_;
@@ -0,0 +1,344 @@
+#ifndef COVID_PI_DATA_SOURCE_H
+#define COVID_PI_DATA_SOURCE_H
+
+#include "io/menu.h"
+#include "json/allocator.h"
+#include "json/document_handler.h"
+#include "json/parallel_parser.h"
+#include "json/stream_parser.h"
+#include "json/validator.h"
+#include "net/chunk_list.h"
+#include "provider.h"
+#include "worker_pool.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <curl/curl.h>
+
+// clang-format off
+enum ParseMode : std::uint8_t {
+    Dom,
+    Sax,
+    Stream,
+    Parallel
+};
+// clang-format on
+
+/**
+ *  The transfer and parse state of a single provider. Keeps the validators of
+ *  its last response for conditional requests and the records it delivered
+ *  last, so they can be merged with the records of the other providers.
+ */
+class data_source final {
+  public:
+    /**
+     *  Duration of each phase of a refresh. Phases which were skipped, e.g.
+     *  DNS and TLS on a reused connection or parsing on a 304, are zero.
+     */
+    struct timings final {
+        std::chrono::microseconds dns{};
+        std::chrono::microseconds connect{};
+        std::chrono::microseconds tls{};
+        // from the established connection until the first response byte
+        std::chrono::microseconds first_byte{};
+        std::chrono::microseconds total{};
+        // time spent parsing, overlaps with the transfer in stream mode
+        std::chrono::microseconds parse{};
+        std::chrono::microseconds sort{};
+        // handing the pages over to the menu, including the first render
+        std::chrono::microseconds publish{};
+    };
+
+    /**
+     *  Counters of the refresh cycles which could be short-circuited.
+     */
+    struct statistics final {
+        // completed transfers
+        std::uint32_t requests{};
+        // 304 responses, nothing was downloaded or parsed
+        std::uint32_t not_modified{};
+        // 200 responses with a body identical to the previous one, their
+        // parse is saved in dom, sax and parallel mode, stream mode has
+        // parsed them while receiving and only saves the sort and publish
+        std::uint32_t unchanged{};
+        // decoded response body bytes received
+        std::uint64_t bytes_received{};
+        // response body bytes transferred, before content decoding
+        std::uint64_t bytes_on_wire{};
+        // body bytes which were not downloaded again due to a 304
+        std::uint64_t bytes_saved{};
+        // transferred and decoded body bytes of the last request
+        std::uint64_t last_bytes_on_wire{};
+        std::uint64_t last_bytes_decoded{};
+        // transfers which did not have to open a new connection
+        std::uint32_t reused_connections{};
+        // heap allocations of the JSON parser during the last request, zero
+        // once the arenas have grown to the size of the response
+        std::uint64_t last_parse_allocations{};
+        timings last_timings{};
+    };
+
+    /**
+     *  @brief  Constructor.
+     *  @param  source  The provider to fetch from.
+     *  @param  country An alpha-2-code to filter by. Empty for no filter.
+     */
+    explicit data_source(provider source, std::string_view country);
+
+    /**
+     *  @brief  Destructor.
+     */
+    ~data_source();
+
+    data_source(data_source const &) = delete;
+    data_source &operator=(data_source const &) = delete;
+
+    /**
+     *  @brief  Returns the name of the provider.
+     */
+    [[nodiscard]] std::string const &name() const noexcept;
+
+    /**
+     *  @brief  Returns how the records of the provider are merged.
+     */
+    [[nodiscard]] MergePolicy merge_policy() const noexcept;
+
+    /**
+     *  @brief  Overrides the provider URL.
+     *  @param  url The URL.
+     */
+    void set_url(std::string const &url) noexcept;
+
+    /**
+     *  @brief  Limits the receive rate to emulate a slow connection.
+     *  @param  bytes_per_second    The rate limit, 0 for unlimited.
+     */
+    void set_max_recv_speed(std::int64_t bytes_per_second) noexcept;
+
+    /**
+     *  @brief  Sets the preferred size of the chunks handed to the write
+     *          callback.
+     *  @param  bytes   The chunk size, clamped by libcurl to 1KB..512KB.
+     */
+    void set_chunk_size(long bytes) noexcept;
+
+    /**
+     *  @brief  Sets the maximum timeout to wait for a request to finish.
+     *  @param timeout  The maximum timeout in seconds before the request should
+     * be aborted.
+     */
+    void set_timeout(long timeout) noexcept;
+
+    /**
+     *  @brief  Limits the size of the response body. Larger responses are
+     *          aborted, if possible before their body is received.
+     *  @param  bytes   The maximum decoded body size.
+     */
+    void set_max_body_size(std::size_t bytes) noexcept;
+
+    /**
+     *  @brief  Specifies how the response body is parsed. Must be called
+     *          before setup(). The parallel mode falls back to the stream
+     *          mode on a single core.
+     *  @param  parse_mode  The parse mode.
+     */
+    void set_parse_mode(ParseMode parse_mode) noexcept;
+
+    /**
+     *  @brief  Enables or disables the validation of the response against
+     *          the schema of the provider. Enabled by default.
+     *  @param  validate    Whether to validate.
+     */
+    void set_validation(bool validate);
+
+    /**
+     *  @brief  Prepare the Curl Request.
+     *  @return  True if successful, otherwise false.
+     */
+    [[nodiscard]] bool setup() noexcept;
+
+    /**
+     *  @brief  Resets the receive state and attaches the conditional request
+     *          headers of the previous response.
+     *  @return The easy handle to be performed.
+     */
+    [[nodiscard]] CURL *prepare_request() noexcept;
+
+    /**
+     *  @brief  Evaluates the completed transfer: counts it and parses the
+     *          body unless the response is a 304 or identical to the last one.
+     *
+     *  The hash of the body is only known once all of it has been received.
+     *  In stream mode it has been parsed by then, an identical body keeps the
+     *  current pages and skips the sort and the publish, but not the parse.
+     *  @return True if successful, otherwise false.
+     */
+    [[nodiscard]] bool finish();
+
+    /**
+     *  @brief  Determines whether the last finished transfer delivered a new
+     *          body, i.e. the pages have been replaced.
+     */
+    [[nodiscard]] bool modified() const noexcept;
+
+    /**
+     *  @brief  Returns the records of the last body which was parsed.
+     */
+    [[nodiscard]] io::menu::pages_type &pages() noexcept;
+
+    /**
+     *  @brief  Returns the counters of this source.
+     */
+    [[nodiscard]] statistics const &stats() const noexcept;
+
+    /**
+     *  @brief  Returns how long the last response stays fresh according to
+     *          its Cache-Control max-age or Expires header.
+     *  @return The freshness lifetime or 0 if the server did not specify one.
+     */
+    [[nodiscard]] std::chrono::seconds freshness() const noexcept;
+
+    /**
+     *  @brief  Determines whether the last request delivered new data, i.e.
+     *          any record has a newer "updated" timestamp than before.
+     */
+    [[nodiscard]] bool data_changed() const noexcept;
+
+  private:
+    /**
+     *  @brief  The callback for received body data. Hashes the data and
+     *          either buffers or parses it depending on the parse mode.
+     *  @return Returns the number of bytes consumed. Any other value aborts
+     *          the transfer.
+     */
+    static std::size_t write_callback(char *ptr, std::size_t size,
+                                      std::size_t nmemb, void *userdata);
+
+    /**
+     *  @brief  The callback for received headers. Collects the ETag and
+     *          Last-Modified validators of the response.
+     *  @return Returns the number of bytes consumed.
+     */
+    static std::size_t header_callback(char *buffer, std::size_t size,
+                                       std::size_t nitems, void *userdata);
+
+    /**
+     *  @brief  The callback for transfer progress. Drives the status LED
+     *          animation.
+     *  @return Always 0 to continue the transfer.
+     */
+    static int progress_callback(void *clientp, std::int64_t dltotal,
+                                 std::int64_t dlnow, std::int64_t ultotal,
+                                 std::int64_t ulnow);
+
+    /**
+     *  @brief  Checks whether the response looks like the expected JSON
+     *          document before any of its body is buffered or parsed: a
+     *          successful status, a JSON content type and an object as the
+     *          first value.
+     *  @param  data    The first chunk of the body.
+     *  @param  size    The chunk size in bytes.
+     *  @return False if the transfer should be aborted, otherwise true.
+     */
+    [[nodiscard]] bool check_response(char const *data, std::size_t size);
+
+    /**
+     *  @brief  Updates the statistics with the transfer info of the finished
+     *          request.
+     */
+    void update_stats() noexcept;
+
+    /**
+     *  @brief  Parses the buffered response body into a DOM and collects
+     *          its records.
+     *  @param  pages   The pages to be filled.
+     *  @param  latest_update   The newest "updated" timestamp of the pages.
+     *  @return True if successful, otherwise false.
+     */
+    [[nodiscard]] bool parse_dom(io::menu::pages_type &pages,
+                                 std::int64_t &latest_update);
+
+    /**
+     *  @brief  Parses the buffered response body with a SAX handler which
+     *          writes the records directly into the pages.
+     *  @param  pages   The pages to be filled.
+     *  @param  latest_update   The newest "updated" timestamp of the pages.
+     *  @return True if successful, otherwise false.
+     */
+    [[nodiscard]] bool parse_sax(io::menu::pages_type &pages,
+                                 std::int64_t &latest_update);
+
+  private:
+    // connections, TLS sessions and resolved addresses are kept longer than
+    // a refresh cycle so they can be reused by the next request
+    static constexpr long CONNECTION_MAX_AGE = 30 * 60;
+    static constexpr long DNS_CACHE_TIMEOUT = 30 * 60;
+    // several times the size of the cities response
+    static constexpr std::size_t DEFAULT_MAX_BODY_SIZE = 8 * 1024 * 1024;
+    // initial sizes of the DOM arenas, grown to fit the first response
+    static constexpr std::size_t VALUE_ARENA_SIZE = 64 * 1024;
+    static constexpr std::size_t STACK_ARENA_SIZE = 16 * 1024;
+
+    provider provider_;
+    std::string_view country_;
+    // the interned country_, 0 for no filter
+    std::uint16_t country_code_;
+    CURL *handle_;
+    curl_slist *request_headers_{nullptr};
+    net::chunk_list body_;
+    std::size_t max_body_size_{DEFAULT_MAX_BODY_SIZE};
+    // whether the response passed check_response()
+    bool body_checked_{false};
+    json::stream_parser stream_parser_;
+    json::document_handler document_handler_;
+    // started by the first parallel parse, kept across refreshes
+    worker_pool workers_;
+    json::parallel_parser parallel_parser_;
+    json::reader sax_reader_;
+    // compiled once, shared by all parse modes
+    json::validator validator_;
+    // kept across refreshes, so validating does not allocate their stacks
+    std::unique_ptr<json::schema_validator<rapidjson::BaseReaderHandler<>>>
+        dom_validator_;
+    std::unique_ptr<json::schema_validator<json::document_handler>>
+        sax_validator_;
+    bool validate_{false};
+    // the DOM is built in arenas which are kept across refreshes
+    json::counting_allocator json_allocator_;
+    json::arena value_arena_{VALUE_ARENA_SIZE};
+    json::arena stack_arena_{STACK_ARENA_SIZE};
+    std::uint64_t allocations_before_{};
+    ParseMode parse_mode_{ParseMode::Stream};
+    io::menu::pages_type pages_;
+    bool modified_{false};
+
+    // validators of the last parsed response
+    std::string etag_;
+    std::string last_modified_;
+    // validators of the response currently being received
+    std::string response_etag_;
+    std::string response_last_modified_;
+    // freshness of the response currently being received, -1 if unknown
+    long response_max_age_{-1};
+    std::time_t response_expires_{-1};
+    std::time_t response_date_{-1};
+
+    // newest "updated" timestamp of the parsed pages
+    std::int64_t latest_update_{};
+    bool data_changed_{false};
+
+    std::chrono::steady_clock::duration parse_time_{};
+    std::uint64_t body_hash_{};
+    std::uint64_t body_size_{};
+    std::uint64_t last_body_hash_{};
+    std::uint64_t last_body_size_{};
+    statistics stats_{};
+};
+
+#endif // COVID_PI_DATA_SOURCE_H
@@ -0,0 +1,144 @@
+#ifndef COVID_PI_HISTORY_H
+#define COVID_PI_HISTORY_H
+
+#include "io/menu.h"
+#include "json/covid_data.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+/**
+ *  Keeps the recent samples of each location in a ring buffer of fixed depth.
+ *  All storage is allocated up front from a memory ceiling, which bounds the
+ *  number of locations: the first locations seen keep their rings, any
+ *  further ones are not tracked. Appending a sample is O(1) and never
+ *  allocates, a full ring overwrites its oldest sample.
+ */
+class history final {
+  public:
+    using id_type = std::uint32_t;
+    using size_type = std::size_t;
+
+    static constexpr id_type NOT_FOUND = ~id_type{0};
+    static constexpr size_type DEFAULT_MEMORY = 4 * 1024 * 1024;
+    // two weeks of hourly updates and then some
+    static constexpr size_type DEFAULT_DEPTH = 512;
+
+    struct sample final {
+        // seconds since the epoch
+        std::int64_t time;
+        std::int32_t confirmed;
+        std::int32_t dead;
+        std::int32_t recovered;
+    };
+
+    using visitor = std::function<void(std::uint16_t code,
+                                       std::string_view name,
+                                       sample const &value)>;
+
+    /**
+     *  @brief  Constructor, the history is disabled until resized.
+     */
+    history() noexcept = default;
+
+    /**
+     *  @brief  Constructor, preallocates the whole history.
+     *  @param  max_bytes   The memory ceiling, 0 disables the history.
+     *  @param  depth       The number of samples kept per location.
+     */
+    explicit history(size_type max_bytes, size_type depth);
+
+    /**
+     *  @brief  Returns the sample of a page.
+     *  @param  page    The page.
+     *  @param  now     The seconds since the epoch of the refresh, used if
+     *                  the record has no timestamp.
+     */
+    [[nodiscard]] static sample to_sample(io::menu::page_type const &page,
+                                          std::int64_t now) noexcept;
+
+    /**
+     *  @brief  Appends a sample for each page whose record changed since
+     *          the last sample of its location.
+     *  @param  pages   The pages of a refresh.
+     *  @param  now     The seconds since the epoch of the refresh, used for
+     *                  records without a timestamp.
+     */
+    void record(io::menu::pages_type const &pages, std::int64_t now) noexcept;
+
+    /**
+     *  @brief  Appends a sample to the ring of a location.
+     *  @param  code    The interned alpha-2 code of the location.
+     *  @param  name    The name of the location.
+     *  @param  value   The sample.
+     *  @return False if the location is not tracked, otherwise true.
+     */
+    bool append(std::uint16_t code, std::string_view name,
+                sample const &value) noexcept;
+
+    /**
+     *  @brief  Looks up the id of a location.
+     *  @return The id or NOT_FOUND if the location is not tracked.
+     */
+    [[nodiscard]] id_type find(std::uint16_t code,
+                               std::string_view name) const noexcept;
+
+    /**
+     *  @brief  Returns the number of samples of a location.
+     */
+    [[nodiscard]] size_type count(id_type id) const noexcept;
+
+    /**
+     *  @brief  Returns a sample of a location.
+     *  @param  id      The id of the location.
+     *  @param  index   The index of the sample, 0 is the oldest one.
+     */
+    [[nodiscard]] sample const &at(id_type id, size_type index) const noexcept;
+
+    /**
+     *  @brief  Returns the number of tracked locations.
+     */
+    [[nodiscard]] size_type locations() const noexcept;
+
+    /**
+     *  @brief  Returns the maximum number of tracked locations.
+     */
+    [[nodiscard]] size_type capacity() const noexcept;
+
+    /**
+     *  @brief  Returns the number of samples kept per location.
+     */
+    [[nodiscard]] size_type depth() const noexcept;
+
+  private:
+    /**
+     *  @brief  Finds the slot of a location in the lookup table, either the
+     *          one holding it or the empty one it belongs into.
+     */
+    [[nodiscard]] size_type slot(std::uint16_t code,
+                                 std::string_view name) const noexcept;
+
+    // bytes per tracked location besides its samples, see the constructor
+    static constexpr size_type LOCATION_OVERHEAD =
+        sizeof(std::array<char, MAX_COUNTRY_NAME_LEN + 1>) +
+        sizeof(std::uint16_t) + 2 * sizeof(std::uint32_t) +
+        4 * sizeof(id_type);
+
+    size_type depth_{0};
+    size_type capacity_{0};
+    // the interned locations, indexed by id
+    std::vector<std::array<char, MAX_COUNTRY_NAME_LEN + 1>> names_;
+    std::vector<std::uint16_t> codes_;
+    // open addressing table of ids + 1, 0 marks an empty slot
+    std::vector<id_type> table_;
+    // a ring of depth_ samples per location
+    std::vector<sample> samples_;
+    std::vector<std::uint32_t> heads_;
+    std::vector<std::uint32_t> counts_;
+};
+
+#endif // COVID_PI_HISTORY_H
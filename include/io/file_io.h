@@ -0,0 +1,38 @@
+#ifndef COVID_PI_FILE_IO_H
+#define COVID_PI_FILE_IO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace io {
+    /**
+     *  @brief  Fills in the format and dataset key of a file header.
+     *  @tparam Format  The file format, which provides its header type,
+     *                  MAGIC and VERSION.
+     *  @param  api     The API type the data was requested from.
+     *  @param  country The alpha-2-code the data was filtered by.
+     */
+    template <typename Format>
+    typename Format::header make_header(std::uint8_t api,
+                                        std::string_view country) noexcept {
+        typename Format::header h{};
+        h.magic = Format::MAGIC;
+        h.version = Format::VERSION;
+        h.api = api;
+        std::copy_n(std::begin(country),
+                    std::min(country.size(), h.country.size() - 1),
+                    std::begin(h.country));
+        return h;
+    }
+
+    /**
+     *  @brief  Writes the whole buffer, retrying on partial writes.
+     *  @return True if successful, otherwise false.
+     */
+    [[nodiscard]] bool write_all(int fd, void const *data,
+                                 std::size_t size) noexcept;
+} // namespace io
+
+#endif // COVID_PI_FILE_IO_H
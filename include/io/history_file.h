@@ -0,0 +1,162 @@
+#ifndef COVID_PI_HISTORY_FILE_H
+#define COVID_PI_HISTORY_FILE_H
+
+#include "../history.h"
+#include "../json/covid_data.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace io {
+    /**
+     *  Append-only file of the records which changed with each refresh,
+     *  so the history survives a reboot. Unlike the history itself it is
+     *  not bounded by a number of locations.
+     *
+     *  Layout (native endianness, the file never leaves the device):
+     *  header, followed by a block per refresh which changed any record.
+     *  A block holds one entry per changed location: its varint id and the
+     *  zigzag varint deltas of the time and counts to its previous sample.
+     *  The first entry of a location within a segment of SEGMENT_BLOCKS
+     *  blocks also defines its code and name and is relative to the block's
+     *  time and zero counts, so decoding may start at any segment.
+     *
+     *  The block index, a second file with an index_entry per block, tells
+     *  where each block starts and when it was recorded. Queries map both
+     *  files read-only.
+     */
+    class history_file final {
+      public:
+        static constexpr std::array<char, 4> MAGIC{'C', 'P', 'H', 'F'};
+        static constexpr std::uint16_t VERSION = 1;
+        static constexpr std::size_t SEGMENT_BLOCKS = 64;
+
+        struct header final {
+            std::array<char, 4> magic;
+            std::uint16_t version;
+            // the dataset the samples belong to
+            std::uint8_t api;
+            std::array<char, MAX_COUNTRY_CODE_LEN + 1> country;
+        };
+
+        struct index_entry final {
+            // position of the block within the history file
+            std::uint64_t offset;
+            // seconds since the epoch of the refresh
+            std::int64_t time;
+            std::uint32_t size;
+            std::uint32_t count;
+            // FNV-1a hash of the block
+            std::uint64_t checksum;
+        };
+
+        history_file() = default;
+        history_file(history_file const &) = delete;
+        history_file &operator=(history_file const &) = delete;
+
+        /**
+         *  @brief  Destructor, closes the files.
+         */
+        ~history_file();
+
+        /**
+         *  @brief  Opens the files for appending. They are created if they
+         *          do not exist yet and replaced if they belong to another
+         *          dataset. A block which was not written completely is
+         *          discarded.
+         *  @param  path    The history file, the block index is stored next
+         *                  to it with an ".idx" suffix.
+         *  @param  api     The API type the samples are requested from.
+         *  @param  country The alpha-2-code the samples are filtered by.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool open(std::string const &path, std::uint8_t api,
+                                std::string_view country);
+
+        /**
+         *  @brief  Determines whether the files have been opened.
+         */
+        [[nodiscard]] bool is_open() const noexcept;
+
+        /**
+         *  @brief  Starts the block of a refresh.
+         *  @param  time    The seconds since the epoch of the refresh.
+         */
+        void begin(std::int64_t time) noexcept;
+
+        /**
+         *  @brief  Adds a sample to the current block.
+         *  @param  code    The interned alpha-2 code of the location.
+         *  @param  name    The name of the location.
+         *  @param  value   The sample.
+         */
+        void add(std::uint16_t code, std::string_view name,
+                 history::sample const &value);
+
+        /**
+         *  @brief  Appends the current block and its index entry, unless it
+         *          is empty. The cost depends on the number of samples
+         *          added, not on the size of the file.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool commit();
+
+        /**
+         *  @brief  Visits the samples of the refreshes recorded within a
+         *          period, oldest first. The files are mapped read-only
+         *          while they are scanned.
+         *  @param  from    The start of the period in seconds since the
+         *                  epoch, inclusive.
+         *  @param  to      The end of the period, exclusive.
+         *  @param  visit   The visitor of each sample, the name is only
+         *                  valid during the call.
+         *  @return False if the files could not be read or are corrupted,
+         *          otherwise true.
+         */
+        [[nodiscard]] bool scan(std::int64_t from, std::int64_t to,
+                                history::visitor const &visit) const;
+
+      private:
+        /**
+         *  The state of a location while encoding a segment.
+         */
+        struct location final {
+            std::uint32_t id;
+            history::sample last;
+        };
+
+        /**
+         *  @brief  Truncates the files to the blocks which have been written
+         *          completely and restores the state of the last segment.
+         */
+        [[nodiscard]] bool recover();
+
+        /**
+         *  @brief  Closes the files.
+         */
+        void close() noexcept;
+
+        std::string path_;
+        std::string index_path_;
+        int fd_{-1};
+        int index_fd_{-1};
+        std::uint64_t size_{0};
+        std::uint64_t blocks_{0};
+        std::int64_t last_time_{0};
+
+        // the block being built
+        std::int64_t time_{0};
+        std::uint32_t count_{0};
+        std::string block_;
+        // the locations of the current segment, by name and code
+        std::unordered_map<std::string, location> locations_;
+        std::string key_;
+    };
+} // namespace io
+
+#endif // COVID_PI_HISTORY_FILE_H
@@ -61,7 +61,10 @@ namespace io {
 
       private:
         /**
-         *  @brief  The input thread itself. Handles the input and the LCD Menu.
+         *  @brief  The input thread itself. Handles the input and the LCD Menu,
+         *          it is the only thread which renders the pages. Pressing
+         *          both buttons at once switches the menu mode, a single
+         *          button turns the page after one debounce period.
          */
         void process_inputs_thread();
 
@@ -1,12 +1,12 @@
 #ifndef COVID_PI_MENU_H
 #define COVID_PI_MENU_H
 
+#include "page_store.h"
 #include "../json/covid_data.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
-#include <mutex>
-#include <vector>
 
 #include <rapidjson/document.h>
 
@@ -21,31 +21,70 @@ namespace io {
         ROW7 = 7 * 8,
     };
 
+    // clang-format off
+    enum MenuMode : std::uint8_t {
+        // the records of all locations
+        Pages,
+        // the locations which grew the most since the previous refresh
+        Movers
+    };
+    // clang-format on
+
+    /**
+     *  The pages are published as immutable snapshots: a refresh swaps in a
+     *  new one atomically and never touches the display, the input handler
+     *  thread reads the current snapshot without blocking and is the only
+     *  one which renders.
+     */
     class menu final {
       public:
-        using page_type = std::unique_ptr<covid_data>;
-        using pages_type = std::vector<page_type>;
+        using page_type = page_store::row;
+        using pages_type = page_store;
+        using snapshot_type = std::shared_ptr<pages_type const>;
         using size_type = pages_type::size_type;
 
         /**
-         *  @brief   Adds the menu pages using move sementics.
+         *  @brief   Publishes the menu pages using move sementics. The
+         *           current page is rendered by the next call of render().
+         */
+        void add_menu(pages_type &&pages);
+
+        /**
+         *  @brief  Publishes the movers of the last refresh, whose counts
+         *          are the deltas to the previous one.
+         */
+        void add_movers(pages_type &&movers);
+
+        /**
+         *  @brief  Switches between the pages and the movers, starting at
+         *          the first page of the other mode.
          */
-        void add_menu(pages_type &&pages) noexcept;
+        void toggle_mode() noexcept;
 
         /**
-         *  @brief Renders the current page to the OLED display.
+         *  @brief  Renders the current page to the OLED display, unless it
+         *          is on display already. A refresh only renders it again if
+         *          it shows a different record or its record has been
+         *          updated. Must only be called by a single thread.
          */
         void render() noexcept;
 
         /**
-         *  @brief  Returns an immutable reference of the menu pages.
+         *  @brief  Returns the snapshot of the pages published last, null
+         *          before the first one.
          */
-        [[nodiscard]] pages_type const &pages() const noexcept;
+        [[nodiscard]] snapshot_type pages() const noexcept;
 
         /**
-         *  @brief  Returns a mutable reference of the menu pages.
+         *  @brief  Returns the snapshot of the movers published last, null
+         *          before the first one.
          */
-        [[nodiscard]] pages_type &pages() noexcept;
+        [[nodiscard]] snapshot_type movers() const noexcept;
+
+        /**
+         *  @brief  Returns the current mode.
+         */
+        [[nodiscard]] MenuMode mode() const noexcept;
 
         /**
          *  @brief  Sets the current page to the previous one.
@@ -58,24 +97,33 @@ namespace io {
         void next() noexcept;
 
         /**
-         *  @brief  Returns the total number of pages.
+         *  @brief  Returns the total number of pages of the current mode.
          */
         [[nodiscard]] size_type size() const noexcept;
 
+      private:
         /**
-         *  @brief  Returns the current immutable page.
+         *  @brief  Returns the snapshot shown in a mode.
          */
-        [[nodiscard]] covid_data const *current() const noexcept;
+        [[nodiscard]] snapshot_type snapshot(MenuMode mode) const noexcept;
 
         /**
-         *  @brief  Returns the current mutable page.
+         *  @brief  Returns the index of the current page within a snapshot,
+         *          the first page if the snapshot has fewer pages.
          */
-        [[nodiscard]] covid_data *current() noexcept;
-
-      private:
-        std::mutex display_mutex_;
-        size_type index_;
-        pages_type pages_;
+        [[nodiscard]] size_type current_index(
+            pages_type const &pages) const noexcept;
+
+        // only accessed through std::atomic_load() and std::atomic_store()
+        snapshot_type pages_;
+        snapshot_type movers_;
+        std::atomic<MenuMode> mode_{MenuMode::Pages};
+        std::atomic<size_type> index_{0};
+        // what is on the display, only touched by the rendering thread
+        snapshot_type rendered_pages_;
+        covid_data rendered_{};
+        size_type rendered_index_{};
+        MenuMode rendered_mode_{MenuMode::Pages};
     };
 } // namespace io
 
@@ -0,0 +1,177 @@
+#ifndef COVID_PI_PAGE_STORE_H
+#define COVID_PI_PAGE_STORE_H
+
+#include "../json/covid_data.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace io {
+    /**
+     *  Column-wise storage of the menu pages. The names are kept back to back
+     *  in a single buffer, the codes and counts in an array per field, so a
+     *  page set costs a handful of allocations instead of one per location
+     *  and sorting by a count scans a contiguous array. The pages are
+     *  accessed through lightweight row views.
+     */
+    class page_store final {
+      public:
+        using size_type = std::size_t;
+
+        /**
+         *  Read-only view of a single page. Valid until the store is
+         *  modified.
+         */
+        class row final {
+          public:
+            /**
+             *  @brief  Constructor.
+             *  @param  store   The store the page belongs to.
+             *  @param  index   The index of the page.
+             */
+            row(page_store const &store, size_type index) noexcept
+                : store_(&store), index_(index) {
+            }
+
+            /**
+             *  @brief  Returns the name of the location. The view is null
+             *          terminated.
+             */
+            [[nodiscard]] std::string_view name() const noexcept {
+                return {store_->names_.data() + store_->name_offsets_[index_],
+                        store_->name_sizes_[index_]};
+            }
+
+            /**
+             *  @brief  Returns the interned alpha-2 code, 0 if unknown.
+             */
+            [[nodiscard]] std::uint16_t code() const noexcept {
+                return store_->codes_[index_];
+            }
+
+            [[nodiscard]] std::int32_t confirmed() const noexcept {
+                return store_->confirmed_[index_];
+            }
+
+            [[nodiscard]] std::int32_t dead() const noexcept {
+                return store_->dead_[index_];
+            }
+
+            [[nodiscard]] std::int32_t recovered() const noexcept {
+                return store_->recovered_[index_];
+            }
+
+            /**
+             *  @brief  Returns the seconds since the epoch of the last
+             *          update, 0 if unknown.
+             */
+            [[nodiscard]] std::int64_t updated() const noexcept {
+                return store_->updated_[index_];
+            }
+
+            /**
+             *  @brief  Copies the page into a single record.
+             */
+            [[nodiscard]] covid_data record() const noexcept;
+
+          private:
+            page_store const *store_;
+            size_type index_;
+        };
+
+        /**
+         *  @brief  Removes all pages, the capacity is kept.
+         */
+        void clear() noexcept;
+
+        /**
+         *  @brief  Reserves the columns for a number of pages.
+         *  @param  count   The number of pages.
+         */
+        void reserve(size_type count);
+
+        /**
+         *  @brief  Appends a page.
+         *  @param  record  The record of the page.
+         */
+        void push_back(covid_data const &record);
+
+        /**
+         *  @brief  Appends all pages of another store.
+         *  @param  other   The store whose pages are appended.
+         */
+        void append(page_store const &other);
+
+        /**
+         *  @brief  Overwrites the counts and the timestamp of a page, its
+         *          name and code are kept.
+         *  @param  index   The index of the page.
+         *  @param  record  The record holding the new counts.
+         */
+        void set_counts(size_type index, covid_data const &record) noexcept;
+
+        /**
+         *  @brief  Sorts the pages. The comparison is evaluated on row views,
+         *          the columns are permuted once afterwards.
+         *  @param  comp    A strict weak ordering of two rows.
+         */
+        template <typename Compare>
+        void sort(Compare &&comp);
+
+        /**
+         *  @brief  Returns the page at the given index.
+         */
+        [[nodiscard]] row operator[](size_type index) const noexcept {
+            return {*this, index};
+        }
+
+        /**
+         *  @brief  Returns the total number of pages.
+         */
+        [[nodiscard]] size_type size() const noexcept {
+            return codes_.size();
+        }
+
+        /**
+         *  @brief  Determines whether there are no pages.
+         */
+        [[nodiscard]] bool empty() const noexcept {
+            return codes_.empty();
+        }
+
+      private:
+        /**
+         *  @brief  Reorders the columns.
+         *  @param  order   The index of the page which goes to each position.
+         */
+        void permute(std::vector<std::uint32_t> const &order);
+
+        // null terminated names, addressed by offset and size
+        std::string names_;
+        std::vector<std::uint32_t> name_offsets_;
+        std::vector<std::uint8_t> name_sizes_;
+        std::vector<std::uint16_t> codes_;
+        std::vector<std::int32_t> confirmed_;
+        std::vector<std::int32_t> dead_;
+        std::vector<std::int32_t> recovered_;
+        std::vector<std::int64_t> updated_;
+    };
+
+    template <typename Compare>
+    void page_store::sort(Compare &&comp) {
+        std::vector<std::uint32_t> order(size());
+        std::iota(std::begin(order), std::end(order), 0);
+        std::sort(std::begin(order), std::end(order),
+                  [this, &comp](std::uint32_t lhs, std::uint32_t rhs) {
+                      return comp((*this)[lhs], (*this)[rhs]);
+                  });
+        permute(order);
+    }
+} // namespace io
+
+#endif // COVID_PI_PAGE_STORE_H
@@ -0,0 +1,66 @@
+#ifndef COVID_PI_SNAPSHOT_H
+#define COVID_PI_SNAPSHOT_H
+
+#include "menu.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace io {
+    /**
+     *  Binary snapshot of the menu pages, so the last known data can be shown
+     *  right after boot instead of waiting for the first refresh.
+     *
+     *  Layout (native endianness, the file never leaves the device):
+     *  header, followed by header.count covid_data records.
+     */
+    struct snapshot final {
+        static constexpr std::array<char, 4> MAGIC{'C', 'P', 'S', 'N'};
+        static constexpr std::uint16_t VERSION = 3;
+
+        struct header final {
+            std::array<char, 4> magic;
+            std::uint16_t version;
+            // guards against a changed covid_data layout
+            std::uint16_t record_size;
+            std::uint32_t count;
+            // the dataset the pages belong to
+            std::uint8_t api;
+            std::array<char, MAX_COUNTRY_CODE_LEN + 1> country;
+            // FNV-1a hash of the records
+            std::uint64_t checksum;
+        };
+
+        /**
+         *  @brief  Writes the pages to a snapshot file. The file is replaced
+         *          atomically, a crash never leaves a truncated snapshot.
+         *  @param  path    The snapshot file.
+         *  @param  api     The API type the pages were requested from.
+         *  @param  country The alpha-2-code the pages were filtered by.
+         *  @param  pages   The pages to be written.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] static bool save(std::string const &path,
+                                       std::uint8_t api,
+                                       std::string_view country,
+                                       menu::pages_type const &pages) noexcept;
+
+        /**
+         *  @brief  Reads the pages from a memory-mapped snapshot file.
+         *  @param  path    The snapshot file.
+         *  @param  api     The expected API type.
+         *  @param  country The expected alpha-2-code filter.
+         *  @param  pages   The pages to be filled.
+         *  @return True if a valid snapshot of the same dataset was found,
+         *          otherwise false.
+         */
+        [[nodiscard]] static bool load(std::string const &path,
+                                       std::uint8_t api,
+                                       std::string_view country,
+                                       menu::pages_type &pages);
+    };
+} // namespace io
+
+#endif // COVID_PI_SNAPSHOT_H
@@ -0,0 +1,28 @@
+#ifndef COVID_PI_STATUS_LEDS_H
+#define COVID_PI_STATUS_LEDS_H
+
+#include <chrono>
+
+namespace io {
+    /**
+     *  The green and red status LEDs, which alternate while a refresh is in
+     *  progress.
+     */
+    struct status_leds final {
+        static constexpr auto BLINK_INTERVAL = std::chrono::milliseconds{250};
+
+        /**
+         *  @brief  Advances the loading animation. Toggles the LEDs if the
+         *          blink interval has elapsed since the last toggle, so it can
+         *          be called as often as desired.
+         */
+        static void tick() noexcept;
+
+        /**
+         *  @brief  Turns off both LEDs.
+         */
+        static void off() noexcept;
+    };
+} // namespace io
+
+#endif // COVID_PI_STATUS_LEDS_H
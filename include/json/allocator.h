@@ -0,0 +1,94 @@
+#ifndef COVID_PI_ALLOCATOR_H
+#define COVID_PI_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <rapidjson/allocators.h>
+#include <rapidjson/encodings.h>
+#include <rapidjson/reader.h>
+
+namespace json {
+    /**
+     *  rapidjson base allocator which forwards to malloc and counts the
+     *  calls, to verify that a warmed-up refresh does not allocate while
+     *  parsing.
+     */
+    class counting_allocator final {
+      public:
+        static constexpr bool kNeedFree = true;
+
+        void *Malloc(std::size_t size);
+        void *Realloc(void *original, std::size_t original_size,
+                      std::size_t new_size);
+        static void Free(void *ptr) noexcept;
+
+        /**
+         *  @brief  Returns the number of allocations made so far.
+         */
+        [[nodiscard]] static std::uint64_t allocations() noexcept;
+
+      private:
+        // the parallel parse mode allocates from several threads
+        static inline std::atomic<std::uint64_t> allocations_{0};
+    };
+
+    using reader = rapidjson::GenericReader<rapidjson::UTF8<>,
+                                            rapidjson::UTF8<>,
+                                            counting_allocator>;
+    using pool_allocator = rapidjson::MemoryPoolAllocator<counting_allocator>;
+
+    /**
+     *  Buffer backing a pool allocator across refreshes. Instead of freeing
+     *  the pool after each parse, the buffer is kept and grown to the size
+     *  the largest parse required, so a steady-state parse fits into it
+     *  without allocating.
+     */
+    class arena final {
+      public:
+        /**
+         *  @brief  Constructor.
+         *  @param  size    The initial size in bytes.
+         */
+        explicit arena(std::size_t size);
+
+        /**
+         *  @brief  Destructor.
+         */
+        ~arena();
+
+        arena(arena const &) = delete;
+        arena &operator=(arena const &) = delete;
+
+        /**
+         *  @brief  Returns an empty pool allocator over the arena, after
+         *          growing it to the size recorded by the previous parse.
+         *          At most one allocator may use the arena at a time.
+         *  @param  base    The allocator of the chunks which do not fit.
+         */
+        [[nodiscard]] pool_allocator allocator(counting_allocator &base);
+
+        /**
+         *  @brief  Records how much of the pool a parse required. Must be
+         *          called before the allocator is destroyed.
+         *  @param  allocator   The allocator returned by allocator().
+         */
+        void record(pool_allocator const &allocator) noexcept;
+
+        /**
+         *  @brief  Returns the size of the arena in bytes.
+         */
+        [[nodiscard]] std::size_t size() const noexcept;
+
+      private:
+        // chunks which did not fit into the arena
+        static constexpr std::size_t CHUNK_CAPACITY = 64 * 1024;
+
+        void *buffer_{nullptr};
+        std::size_t size_{0};
+        std::size_t required_{0};
+    };
+} // namespace json
+
+#endif // COVID_PI_ALLOCATOR_H
@@ -40,7 +40,7 @@
       "updated": "2020-05-19 07:48:43.413081+00:00"
     }
 
-    latitude, longitude, updated fields are ignored.
+    latitude, longitude fields are ignored.
  */
 
 static constexpr auto MAX_COUNTRY_NAME_LEN = 32;
@@ -48,11 +48,13 @@ static constexpr auto MAX_COUNTRY_CODE_LEN = 2;
 
 struct covid_data final {
     std::array<char, MAX_COUNTRY_NAME_LEN + 1> name{};
-    // ISO 3166-1 alpha-2
-    std::array<char, MAX_COUNTRY_CODE_LEN + 1> code{};
+    // ISO 3166-1 alpha-2, interned by utils::intern_alpha_2(), 0 if unknown
+    std::uint16_t code{};
     std::int32_t confirmed{};
     std::int32_t dead{};
     std::int32_t recovered{};
+    // seconds since the epoch of the last update, 0 if unknown
+    std::int64_t updated{};
 };
 
 #endif // COVID_PI_COVID_DATA_H
@@ -0,0 +1,88 @@
+#ifndef COVID_PI_DOCUMENT_HANDLER_H
+#define COVID_PI_DOCUMENT_HANDLER_H
+
+#include "record_handler.h"
+#include "schema.h"
+#include "../io/menu.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <rapidjson/reader.h>
+
+namespace json {
+    /**
+     *  SAX handler for a whole response. Locates the records array and lets
+     *  a record_handler fill each of its elements, which is appended to the
+     *  page storage right away, no DOM is built. Must be parsed with
+     *  kParseNumbersAsStringsFlag.
+     */
+    class document_handler final
+        : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                              document_handler> {
+      public:
+        using SizeType = rapidjson::SizeType;
+
+        /**
+         *  @brief  Constructor.
+         *  @param  country An alpha-2-code to filter by. Empty for no filter.
+         *  @param  keys    The member names of the provider's response.
+         */
+        explicit document_handler(std::string_view country,
+                                  schema const &keys) noexcept;
+
+        /**
+         *  @brief  Resets the handler before the next document is parsed.
+         */
+        void reset() noexcept;
+
+        /**
+         *  @brief  Requires each record to have a name and a country code,
+         *          see record_handler::require_members().
+         *  @param  required    Whether the members are required.
+         */
+        void require_members(bool required) noexcept;
+
+        /**
+         *  @brief  Determines whether the records array has been parsed.
+         */
+        [[nodiscard]] bool complete() const noexcept;
+
+        /**
+         *  @brief  Returns the records parsed so far.
+         */
+        [[nodiscard]] io::menu::pages_type &pages() noexcept;
+
+        /**
+         *  @brief  Returns the newest "updated" timestamp of the records
+         *          parsed so far.
+         */
+        [[nodiscard]] std::int64_t latest_update() const noexcept;
+
+        bool Default() noexcept;
+        bool RawNumber(char const *str, SizeType len, bool copy) noexcept;
+        bool String(char const *str, SizeType len, bool copy);
+        bool Key(char const *str, SizeType len, bool copy);
+        bool StartObject();
+        bool EndObject(SizeType member_count);
+        bool StartArray() noexcept;
+        bool EndArray(SizeType element_count);
+
+      private:
+        record_handler record_;
+        // the record being parsed, appended once it passed the filter
+        covid_data data_{};
+        io::menu::pages_type pages_;
+        std::int64_t latest_update_{};
+        std::string_view records_key_;
+
+        std::uint32_t depth_{0};
+        bool records_key_seen_{false};
+        bool in_records_{false};
+        bool in_record_{false};
+        bool complete_{false};
+    };
+} // namespace json
+
+#endif // COVID_PI_DOCUMENT_HANDLER_H
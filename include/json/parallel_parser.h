@@ -0,0 +1,100 @@
+#ifndef COVID_PI_PARALLEL_PARSER_H
+#define COVID_PI_PARALLEL_PARSER_H
+
+#include "schema.h"
+#include "stream_parser.h"
+#include "../io/menu.h"
+#include "../net/chunk_list.h"
+#include "../worker_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+    /**
+     *  Parses the records array of a buffered response on several threads.
+     *  A structural pre-scan, which only follows strings and nesting, splits
+     *  the array at record boundaries into a slice per worker. Each slice is
+     *  parsed by a stream_parser of its own on a thread of the pool, the
+     *  records are concatenated in document order afterwards.
+     */
+    class parallel_parser final {
+      public:
+        /**
+         *  @brief  Constructor.
+         *  @param  country An alpha-2-code to filter by. Empty for no filter.
+         *  @param  keys    The member names of the provider's response.
+         *  @param  workers The threads which parse the slices, must outlive
+         *                  the parser.
+         */
+        explicit parallel_parser(std::string_view country, schema const &keys,
+                                 worker_pool &workers) noexcept;
+
+        /**
+         *  @brief  Enables or disables the validation of each record.
+         *  @param  record_schema   The schema of a record, must outlive the
+         *                          parser. Null to disable the validation.
+         */
+        void set_validation(schema_document const *record_schema);
+
+        /**
+         *  @brief  Parses a response body.
+         *  @param  body    The buffered body.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool parse(net::chunk_list const &body);
+
+        /**
+         *  @brief  Returns the records of the last parse.
+         */
+        [[nodiscard]] io::menu::pages_type &pages() noexcept;
+
+        /**
+         *  @brief  Returns the newest "updated" timestamp of the records of
+         *          the last parse.
+         */
+        [[nodiscard]] std::int64_t latest_update() const noexcept;
+
+      private:
+        /**
+         *  A part of the records array, starting and ending at record
+         *  boundaries.
+         */
+        struct slice final {
+            std::size_t begin;
+            std::size_t end;
+        };
+
+        /**
+         *  @brief  Locates the records array and splits it into slices of
+         *          roughly equal size.
+         *  @param  body    The buffered body.
+         *  @return False if the document is malformed, otherwise true.
+         */
+        [[nodiscard]] bool split(net::chunk_list const &body);
+
+      private:
+        // smaller slices are not worth a thread, e.g. the countries response
+        // is parsed by a single one
+        static constexpr std::size_t MIN_SLICE_SIZE = 64 * 1024;
+
+        std::string_view country_;
+        schema keys_;
+        worker_pool &workers_;
+        schema_document const *record_schema_{nullptr};
+        // created on first use, kept across refreshes
+        std::vector<std::unique_ptr<stream_parser>> parsers_;
+        std::vector<slice> slices_;
+        // not a std::vector<bool>, the slices are parsed concurrently
+        std::vector<std::uint8_t> results_;
+        io::menu::pages_type pages_;
+        std::int64_t latest_update_{};
+        std::string key_;
+    };
+} // namespace json
+
+#endif // COVID_PI_PARALLEL_PARSER_H
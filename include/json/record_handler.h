@@ -0,0 +1,161 @@
+#ifndef COVID_PI_RECORD_HANDLER_H
+#define COVID_PI_RECORD_HANDLER_H
+
+#include "covid_data.h"
+#include "schema.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <rapidjson/reader.h>
+
+namespace json {
+    /**
+     *  SAX handler which fills a single covid_data record from one element of
+     *  the records array. The member names are looked up in a key table built
+     *  from the provider's schema, unknown and ignored fields (latitude,
+     *  longitude) are skipped. Numbers are expected as raw strings
+     *  (kParseNumbersAsStringsFlag) and only converted once the record is
+     *  complete and has not been filtered out by its country code, which
+     *  may come after the counts. The members following a mismatching
+     *  country code are skipped.
+     *
+     *  When parsed in-situ, the strings are views into the parsed buffer until
+     *  the record is complete, otherwise they are copied into storage which
+     *  is reused for every record.
+     */
+    class record_handler final
+        : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                              record_handler> {
+      public:
+        using SizeType = rapidjson::SizeType;
+
+        // clang-format off
+        enum class field : std::uint8_t {
+            none,
+            location,
+            country_code,
+            confirmed,
+            dead,
+            recovered,
+            updated
+        };
+        // clang-format on
+
+        struct key_entry final {
+            std::string_view key;
+            field value;
+        };
+        using key_table = std::array<key_entry, 6>;
+
+        /**
+         *  @brief  Builds the key table of a schema.
+         *  @param  keys    The member names of the records.
+         */
+        static constexpr key_table make_key_table(schema const &keys) noexcept {
+            return {{{keys.location, field::location},
+                     {keys.country_code, field::country_code},
+                     {keys.confirmed, field::confirmed},
+                     {keys.dead, field::dead},
+                     {keys.recovered, field::recovered},
+                     {keys.updated, field::updated}}};
+        }
+
+        /**
+         *  @brief  Looks up the field of a member name.
+         *  @return The field or field::none if the member is ignored.
+         */
+        static constexpr field find_field(key_table const &table,
+                                          std::string_view key) noexcept {
+            for (auto const &entry : table) {
+                // compares the length first, so most keys are rejected
+                // without looking at their characters
+                if (entry.key == key) {
+                    return entry.value;
+                }
+            }
+            return field::none;
+        }
+
+        /**
+         *  @brief  Constructor.
+         *  @param  keys    The member names of the records.
+         *  @param  country An alpha-2-code to filter by. Empty or an invalid
+         *                  code for no filter.
+         */
+        explicit record_handler(schema const &keys,
+                                std::string_view country = {}) noexcept;
+
+        /**
+         *  @brief  Starts the next record.
+         *  @param  target  The record to be filled, must outlive the parse.
+         */
+        void reset(covid_data &target) noexcept;
+
+        /**
+         *  @brief  Determines whether the record which was parsed last
+         *          passed the country filter. Its name and counts are only
+         *          filled in if so.
+         */
+        [[nodiscard]] bool accepted() const noexcept;
+
+        /**
+         *  @brief  Requires each record to have a name and a country code,
+         *          a record without them fails the parse. The check is done
+         *          here rather than by the record schema, because the
+         *          "required" keyword allocates for every validated record.
+         *  @param  required    Whether the members are required.
+         */
+        void require_members(bool required) noexcept;
+
+        bool Default() noexcept;
+        bool RawNumber(char const *str, SizeType len, bool copy) noexcept;
+        bool String(char const *str, SizeType len, bool copy);
+        bool Key(char const *str, SizeType len, bool copy) noexcept;
+        bool StartObject() noexcept;
+        bool EndObject(SizeType member_count);
+        bool StartArray() noexcept;
+        bool EndArray(SizeType element_count) noexcept;
+
+      private:
+        // the sign and 10 digits of the smallest std::int32_t, longer numbers
+        // are out of range
+        static constexpr std::size_t MAX_COUNT_SIZE = 11;
+        static constexpr std::size_t COUNT_FIELDS = 3;
+
+        key_table keys_;
+        std::string_view location_key_;
+        std::string_view country_code_key_;
+        // the interned code to filter by, 0 for no filter
+        std::uint16_t country_;
+        covid_data *data_{nullptr};
+        std::string_view location_;
+        std::string_view updated_;
+        // raw counts, converted when the record is complete
+        std::array<std::string_view, COUNT_FIELDS> counts_{};
+        // copies of the strings if they are not parsed in-situ
+        std::string location_storage_;
+        std::string updated_storage_;
+        std::array<std::array<char, MAX_COUNT_SIZE>, COUNT_FIELDS>
+            count_storage_{};
+        field field_{field::none};
+        std::uint32_t depth_{0};
+        bool accepted_{true};
+        // the country code did not match, the remaining members are skipped
+        bool rejected_{false};
+        bool require_members_{false};
+        bool has_location_{false};
+        bool has_country_code_{false};
+    };
+
+    static_assert(record_handler::find_field(
+                      record_handler::make_key_table(trackcorona_schema),
+                      "country_code") ==
+                      record_handler::field::country_code,
+                  "trackcorona key table is broken!");
+} // namespace json
+
+#endif // COVID_PI_RECORD_HANDLER_H
@@ -0,0 +1,30 @@
+#ifndef COVID_PI_SCHEMA_H
+#define COVID_PI_SCHEMA_H
+
+#include <string_view>
+
+namespace json {
+    /**
+     *  Maps the JSON member names of a provider's response onto the
+     *  covid_data fields. The records are the elements of an array which is
+     *  a member of the top-level object.
+     */
+    struct schema final {
+        std::string_view records;
+        std::string_view location;
+        std::string_view country_code;
+        std::string_view confirmed;
+        std::string_view dead;
+        std::string_view recovered;
+        std::string_view updated;
+    };
+
+    /**
+     *  The schema of the trackcorona.live API, see covid_data.h.
+     */
+    inline constexpr schema trackcorona_schema{
+        "data", "location", "country_code", "confirmed",
+        "dead", "recovered", "updated"};
+} // namespace json
+
+#endif // COVID_PI_SCHEMA_H
@@ -0,0 +1,111 @@
+#ifndef COVID_PI_STREAM_PARSER_H
+#define COVID_PI_STREAM_PARSER_H
+
+#include "allocator.h"
+#include "record_handler.h"
+#include "schema.h"
+#include "validator.h"
+#include "../io/menu.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <rapidjson/reader.h>
+
+namespace json {
+    /**
+     *  Incremental parser for the API response. Received chunks are scanned
+     *  for the elements of the top-level records array; each element is handed
+     *  to a rapidjson::Reader as soon as its closing brace arrives, so only a
+     *  single record is buffered at a time and no DOM is built.
+     */
+    class stream_parser final {
+      public:
+        /**
+         *  @brief  Constructor.
+         *  @param  country An alpha-2-code to filter by. Empty for no filter.
+         *  @param  keys    The member names of the provider's response.
+         */
+        explicit stream_parser(std::string_view country,
+                               schema const &keys) noexcept;
+
+        /**
+         *  @brief  Enables or disables the validation of each record.
+         *  @param  record_schema   The schema of a record, must outlive the
+         *                          parser. Null to disable the validation.
+         */
+        void set_validation(schema_document const *record_schema);
+
+        /**
+         *  @brief  Resets the parser state before a new transfer starts.
+         */
+        void reset() noexcept;
+
+        /**
+         *  @brief  Resets the parser state before a slice of the records
+         *          array is consumed. The slice must start and end at record
+         *          boundaries, the document around it is not checked.
+         */
+        void reset_records() noexcept;
+
+        /**
+         *  @brief  Consumes the next chunk of the response body.
+         *  @param  data    The received chunk.
+         *  @param  size    The chunk size in bytes.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool feed(char const *data, std::size_t size);
+
+        /**
+         *  @brief  Checks whether the whole document has been consumed.
+         *  @return True if the document was complete, otherwise false.
+         */
+        [[nodiscard]] bool finish() const noexcept;
+
+        /**
+         *  @brief  Returns the records parsed so far.
+         */
+        [[nodiscard]] io::menu::pages_type &pages() noexcept;
+
+        /**
+         *  @brief  Returns the newest "updated" timestamp of the records
+         *          parsed so far.
+         */
+        [[nodiscard]] std::int64_t latest_update() const noexcept;
+
+      private:
+        /**
+         *  @brief  Parses the buffered record and appends it to the pages.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool commit_record();
+
+      private:
+        // a single record is a few hundred bytes, anything larger is an
+        // unterminated or malicious record which must not grow the buffer
+        static constexpr std::size_t MAX_RECORD_SIZE = 16 * 1024;
+
+        json::reader reader_;
+        record_handler handler_;
+        // validates each record before handing it over to the handler
+        std::unique_ptr<schema_validator<record_handler>> validator_;
+        covid_data data_{};
+        io::menu::pages_type pages_;
+        std::string record_;
+        std::string key_;
+        std::int64_t latest_update_{};
+        std::string_view records_key_;
+
+        std::uint32_t depth_{0};
+        bool in_string_{false};
+        bool escape_{false};
+        bool in_data_{false};
+        bool in_record_{false};
+        bool seen_data_{false};
+    };
+} // namespace json
+
+#endif // COVID_PI_STREAM_PARSER_H
@@ -0,0 +1,80 @@
+#ifndef COVID_PI_VALIDATOR_H
+#define COVID_PI_VALIDATOR_H
+
+#include "allocator.h"
+#include "schema.h"
+
+#include <rapidjson/schema.h>
+
+namespace json {
+    using schema_document = rapidjson::SchemaDocument;
+
+    /**
+     *  SAX validator which forwards the events of valid values to a handler,
+     *  so a response is validated and consumed in a single pass.
+     */
+    template <typename Handler>
+    using schema_validator =
+        rapidjson::GenericSchemaValidator<schema_document, Handler,
+                                          counting_allocator>;
+
+    /**
+     *  JSON schemas of a provider's response, generated from its member names
+     *  and compiled once. They check the structure the parsers rely on: the
+     *  records array, records being objects and the types of their names,
+     *  country codes and timestamps. The counts are not typed, they may be
+     *  parsed as raw numbers which rapidjson validates like strings, and any
+     *  value which is not an integer is read as 0 anyway. For the same reason
+     *  a number passes as a name when parsing raw numbers, its text is used.
+     *
+     *  The schemas have no "required" keyword, rapidjson allocates its state
+     *  for every object validated against one. The parsers check for the
+     *  records array themselves, the record handler for the required
+     *  members of a record, so validating a response does not allocate.
+     */
+    class validator final {
+      public:
+        /**
+         *  @brief  Constructor, compiles the schemas.
+         *  @param  keys    The member names of the provider's response.
+         */
+        explicit validator(schema const &keys);
+
+        /**
+         *  @brief  Returns the schema of a whole response.
+         */
+        [[nodiscard]] schema_document const &document() const noexcept;
+
+        /**
+         *  @brief  Returns the schema of a single record.
+         */
+        [[nodiscard]] schema_document const &record() const noexcept;
+
+        /**
+         *  @brief  Prints where a response violates the schema.
+         *  @param  validator   The validator which rejected the response.
+         */
+        template <typename Validator>
+        static void print_error(Validator const &validator);
+
+      private:
+        /**
+         *  @brief  Prints where a response violates the schema.
+         *  @param  pointer The invalid value.
+         *  @param  keyword The schema keyword which is violated.
+         */
+        static void print_error(schema_document::PointerType const &pointer,
+                                char const *keyword);
+
+        schema_document document_;
+        schema_document record_;
+    };
+
+    template <typename Validator>
+    void validator::print_error(Validator const &validator) {
+        print_error(validator.GetInvalidDocumentPointer(),
+                    validator.GetInvalidSchemaKeyword());
+    }
+} // namespace json
+
+#endif // COVID_PI_VALIDATOR_H
@@ -0,0 +1,112 @@
+#ifndef COVID_PI_MOVERS_H
+#define COVID_PI_MOVERS_H
+
+#include "io/menu.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  Compares the pages of a refresh with those of the previous one. The page
+ *  sets are joined by location through a lookup table over the previous
+ *  pages, so a refresh costs linear time regardless of how either set is
+ *  sorted. The locations whose confirmed cases grew the most are selected
+ *  with a heap bounded by the number of movers kept.
+ */
+class movers final {
+  public:
+    using size_type = std::size_t;
+
+    static constexpr size_type DEFAULT_COUNT = 10;
+
+    struct delta final {
+        std::int32_t confirmed;
+        std::int32_t dead;
+        std::int32_t recovered;
+        // the location has no previous record, its deltas are 0
+        bool added;
+        // the location was added or its counts or timestamp differ
+        bool changed;
+    };
+
+    /**
+     *  @brief  Constructor, no movers are kept until resized.
+     */
+    movers() noexcept = default;
+
+    /**
+     *  @brief  Constructor.
+     *  @param  count   The number of movers kept, 0 disables them.
+     */
+    explicit movers(size_type count);
+
+    /**
+     *  @brief  Computes the delta of each page to the record of the same
+     *          location within the previous pages and selects the movers.
+     *          The pages are joined even if no movers are kept, so the
+     *          deltas tell which records changed.
+     *  @param  previous    The pages of the previous refresh.
+     *  @param  pages       The pages of the refresh.
+     *  @return The pages of the movers, the one which grew the most first,
+     *          whose counts are the deltas. Locations without a previous
+     *          record or growth are never movers.
+     */
+    [[nodiscard]] io::menu::pages_type update(
+        io::menu::pages_type const &previous,
+        io::menu::pages_type const &pages);
+
+    /**
+     *  @brief  Returns the deltas of the last update, by the index of the
+     *          page they belong to.
+     */
+    [[nodiscard]] std::vector<delta> const &deltas() const noexcept;
+
+    /**
+     *  @brief  Returns the number of movers kept.
+     */
+    [[nodiscard]] size_type count() const noexcept;
+
+  private:
+    using index_type = std::uint32_t;
+
+    /**
+     *  A candidate, ranked by its growth and then by its position within
+     *  the sorted pages.
+     */
+    struct mover final {
+        std::int32_t confirmed;
+        index_type index;
+    };
+
+    /**
+     *  @brief  Fills the lookup table with the previous pages.
+     */
+    void index(io::menu::pages_type const &previous);
+
+    /**
+     *  @brief  Looks up the next previous record of a location which has
+     *          not been joined yet.
+     *  @return The index within the previous pages or NOT_FOUND.
+     */
+    [[nodiscard]] index_type take(io::menu::pages_type const &previous,
+                                  io::menu::page_type const &page) noexcept;
+
+    static constexpr index_type NOT_FOUND = ~index_type{0};
+
+    size_type count_{0};
+    // open addressing table of indices + 1 into the previous pages, 0 marks
+    // an empty slot, reused across refreshes
+    std::vector<index_type> table_;
+    // per slot the index + 1 of the next record to be joined, 0 once all
+    // records of the location have been joined
+    std::vector<index_type> pending_;
+    // per previous record the index + 1 of the next record of the same
+    // location, 0 for the last one
+    std::vector<index_type> next_;
+    std::vector<delta> deltas_;
+    // the bounded heap, its front is the weakest mover kept
+    std::vector<mover> heap_;
+};
+
+#endif // COVID_PI_MOVERS_H
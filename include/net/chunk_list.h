@@ -0,0 +1,133 @@
+#ifndef COVID_PI_CHUNK_LIST_H
+#define COVID_PI_CHUNK_LIST_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace net {
+    /**
+     *  Receive buffer made of fixed-size chunks. Unlike a growing
+     *  std::string, appending never reallocates or copies the data received
+     *  so far. Cleared chunks stay allocated and are reused by the next
+     *  transfer, so the buffer only grows up to the largest body received.
+     */
+    class chunk_list final {
+      public:
+        static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+        using chunk = std::array<char, CHUNK_SIZE>;
+
+        /**
+         *  Input stream over the buffered data, implements the rapidjson
+         *  stream concept for read-only parsing.
+         */
+        class reader final {
+          public:
+            using Ch = char;
+
+            /**
+             *  @brief  Constructor.
+             *  @param  list    The chunk list to read, must not be modified
+             *                  while it is being read.
+             */
+            explicit reader(chunk_list const &list) noexcept;
+
+            [[nodiscard]] Ch Peek() const noexcept {
+                return pos_ != end_ ? *pos_ : '\0';
+            }
+
+            Ch Take() noexcept {
+                if (pos_ == end_) {
+                    return '\0';
+                }
+                auto const c = *pos_;
+                if (++pos_ == end_) {
+                    next_chunk();
+                }
+                return c;
+            }
+
+            [[nodiscard]] std::size_t Tell() const noexcept {
+                return offset_ + static_cast<std::size_t>(pos_ - begin_);
+            }
+
+            // in-situ parsing is not supported
+            Ch *PutBegin() noexcept;
+            void Put(Ch) noexcept;
+            void Flush() noexcept;
+            std::size_t PutEnd(Ch *) noexcept;
+
+          private:
+            /**
+             *  @brief  Moves on to the next chunk once the current one has
+             *          been consumed.
+             */
+            void next_chunk() noexcept;
+
+            chunk_list const &list_;
+            std::size_t index_{0};
+            // offset of the current chunk within the body
+            std::size_t offset_{0};
+            char const *begin_{nullptr};
+            char const *pos_{nullptr};
+            char const *end_{nullptr};
+        };
+
+        /**
+         *  @brief  Returns all chunks to the pool.
+         */
+        void clear() noexcept;
+
+        /**
+         *  @brief  Appends data, taking chunks from the pool before
+         *          allocating new ones.
+         *  @param  data    The data to be appended.
+         *  @param  size    The size of the data in bytes.
+         */
+        void append(char const *data, std::size_t size);
+
+        /**
+         *  @brief  Hands a range of the buffered data to a function, one
+         *          contiguous piece per chunk.
+         *  @param  begin   The offset of the first byte.
+         *  @param  end     The offset past the last byte.
+         *  @param  f       Called with the data and size of each piece,
+         *                  returns false to stop.
+         *  @return False if stopped by the function, otherwise true.
+         */
+        template <typename Function>
+        bool for_each_piece(std::size_t begin, std::size_t end,
+                            Function &&f) const {
+            end = std::min(end, size_);
+            while (begin < end) {
+                auto const offset = begin % CHUNK_SIZE;
+                auto const size = std::min(end - begin, CHUNK_SIZE - offset);
+                if (!f(chunks_[begin / CHUNK_SIZE]->data() + offset, size)) {
+                    return false;
+                }
+                begin += size;
+            }
+            return true;
+        }
+
+        /**
+         *  @brief  Returns the number of buffered bytes.
+         */
+        [[nodiscard]] std::size_t size() const noexcept;
+
+        /**
+         *  @brief  Returns the number of allocated bytes, including the
+         *          pooled chunks.
+         */
+        [[nodiscard]] std::size_t capacity() const noexcept;
+
+      private:
+        // chunks in use come first, the remaining ones are pooled
+        std::vector<std::unique_ptr<chunk>> chunks_;
+        std::size_t size_{0};
+    };
+} // namespace net
+
+#endif // COVID_PI_CHUNK_LIST_H
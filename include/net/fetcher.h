@@ -0,0 +1,85 @@
+#ifndef COVID_PI_FETCHER_H
+#define COVID_PI_FETCHER_H
+
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+using CURL = void;
+using CURLM = void;
+using CURLSH = void;
+
+namespace net {
+    /**
+     *  Event-driven driver for any number of concurrent transfers on the
+     *  calling thread. Built on the curl multi interface, no thread is
+     *  created per request.
+     *
+     *  Live connections are pooled by the multi handle. Resolved addresses
+     *  and TLS sessions are kept in a share handle attached to every queued
+     *  transfer, so they survive across refresh cycles and are shared
+     *  between all easy handles.
+     */
+    class fetcher final {
+        // upper bound between two iterations of the event loop, so that
+        // progress callbacks keep firing while the connection is idle
+        static constexpr auto POLL_TIMEOUT = std::chrono::milliseconds{250};
+
+      public:
+        /**
+         *  The callback when a transfer has finished. The argument is true if
+         *  the transfer was successful, otherwise false.
+         */
+        using completion_handler = std::function<void(bool)>;
+        using size_type = std::size_t;
+
+        /**
+         *  @brief  Constructor.
+         */
+        fetcher();
+
+        /**
+         *  @brief  Destructor. Aborts all pending transfers.
+         */
+        ~fetcher();
+
+        fetcher(fetcher const &) = delete;
+        fetcher &operator=(fetcher const &) = delete;
+
+        /**
+         *  @brief  Queues a prepared easy handle and attaches the shared DNS
+         *          and TLS session caches. The transfer starts with the next
+         *          call to run().
+         *  @param  handle  The easy handle.
+         *  @param  on_done The callback when the transfer has finished.
+         *  @return True if successful, otherwise false.
+         */
+        [[nodiscard]] bool add(CURL *handle, completion_handler &&on_done);
+
+        /**
+         *  @brief  Drives all queued transfers until every one of them has
+         *          finished.
+         *  @return True if the event loop ran without error, otherwise false.
+         */
+        [[nodiscard]] bool run();
+
+        /**
+         *  @brief  Returns the number of unfinished transfers.
+         */
+        [[nodiscard]] size_type pending() const noexcept;
+
+      private:
+        /**
+         *  @brief  Invokes the completion handlers of finished transfers.
+         */
+        void dispatch();
+
+      private:
+        CURLM *multi_;
+        CURLSH *share_;
+        std::vector<std::pair<CURL *, completion_handler>> transfers_;
+    };
+} // namespace net
+
+#endif // COVID_PI_FETCHER_H
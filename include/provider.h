@@ -0,0 +1,56 @@
+#ifndef COVID_PI_PROVIDER_H
+#define COVID_PI_PROVIDER_H
+
+#include "json/schema.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// clang-format off
+enum APIType : std::uint8_t {
+    Countries,
+    Cities
+};
+
+/**
+ *  How the records of a provider are combined with records of the same
+ *  location which were already delivered by another provider.
+ */
+enum MergePolicy : std::uint8_t {
+    // keep the larger of both counts, e.g. for mirrors which lag behind
+    Max,
+    // add the counts, e.g. for providers covering disjoint sub-regions
+    Sum,
+    // replace the counts, e.g. for a more accurate regional source
+    Override
+};
+// clang-format on
+
+/**
+ *  A source of covid data: where to fetch it, how to read it and how to merge
+ *  it with the data of the other providers.
+ */
+struct provider final {
+    std::string name;
+    std::string url;
+    json::schema schema;
+    MergePolicy merge;
+};
+
+namespace providers {
+    static constexpr std::array<char const *, 2> trackcorona_apis{
+        "https://www.trackcorona.live/api/countries",
+        "https://www.trackcorona.live/api/cities"};
+
+    /**
+     *  @brief  Returns the trackcorona.live provider.
+     *  @param  api_type    The API Type.
+     */
+    inline provider trackcorona(APIType api_type) {
+        return provider{"trackcorona", trackcorona_apis[api_type],
+                        json::trackcorona_schema, MergePolicy::Max};
+    }
+} // namespace providers
+
+#endif // COVID_PI_PROVIDER_H
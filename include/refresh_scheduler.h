@@ -0,0 +1,61 @@
+#ifndef COVID_PI_REFRESH_SCHEDULER_H
+#define COVID_PI_REFRESH_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+/**
+ *  Determines the delay until the next refresh. The polling interval adapts
+ *  to how often the upstream data actually changes and never undercuts the
+ *  freshness lifetime announced by the server. Failed refreshes are retried
+ *  with exponential backoff and jitter.
+ */
+class refresh_scheduler final {
+  public:
+    using duration = std::chrono::seconds;
+
+    static constexpr duration MIN_INTERVAL = std::chrono::minutes{5};
+    static constexpr duration DEFAULT_INTERVAL = std::chrono::minutes{20};
+    static constexpr duration MAX_INTERVAL = std::chrono::hours{2};
+    static constexpr duration MIN_BACKOFF = std::chrono::seconds{15};
+    static constexpr duration MAX_BACKOFF = std::chrono::minutes{30};
+
+    /**
+     *  @brief  Constructor.
+     */
+    refresh_scheduler();
+
+    /**
+     *  @brief  Schedules the next refresh after a successful one.
+     *  @param  data_changed    Whether the refresh delivered new data.
+     *  @param  freshness   The freshness lifetime announced by the server, 0
+     *                      if unknown.
+     *  @return The delay until the next refresh.
+     */
+    [[nodiscard]] duration on_success(bool data_changed,
+                                      duration freshness) noexcept;
+
+    /**
+     *  @brief  Schedules the next attempt after a failed refresh.
+     *  @return The delay until the next attempt.
+     */
+    [[nodiscard]] duration on_failure() noexcept;
+
+    /**
+     *  @brief  Returns the current polling interval.
+     */
+    [[nodiscard]] duration interval() const noexcept;
+
+    /**
+     *  @brief  Returns the number of consecutive failed refreshes.
+     */
+    [[nodiscard]] std::uint32_t failures() const noexcept;
+
+  private:
+    duration interval_{DEFAULT_INTERVAL};
+    std::uint32_t failures_{0};
+    std::minstd_rand rng_;
+};
+
+#endif // COVID_PI_REFRESH_SCHEDULER_H
@@ -6,7 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
 #include <rapidjson/document.h>
 
@@ -71,41 +71,338 @@ namespace utils {
         "ZW", "ZX", "ZY", "ZZ"};
 
     /**
-     *  @brief  Determines whether the given alpha-2-code is valid.
-     *  @param  needle  The country code to be checked. Will be copied and
-     *                  transformed into capital letters.
+     *  An interned ISO 3166-1 alpha-2 code, 1 + its index in alpha_2_codes,
+     *  e.g. "AA" is 1 and "ZZ" is 676. 0 denotes an unknown code.
+     */
+    using alpha_2_id = std::uint16_t;
+
+    /**
+     *  @brief  Returns the index of a letter of an alpha-2-code.
+     *  @return The index 0..25 or -1 if the character is not a letter.
+     */
+    constexpr static auto alpha_2_letter(char c) noexcept -> int {
+        if (c >= 'A' && c <= 'Z') {
+            return c - 'A';
+        }
+        if (c >= 'a' && c <= 'z') {
+            return c - 'a';
+        }
+        return -1;
+    }
+
+    /**
+     *  @brief  Builds the 26x26 bitset of the valid codes, a row of 26 bits
+     *          per first letter.
      */
-    static auto has_alpha_2_code(std::string needle) -> bool {
-        std::transform(std::begin(needle), std::end(needle), std::begin(needle),
-                       [](auto &&c) { return std::toupper(c); });
+    constexpr static auto make_alpha_2_bitset() noexcept
+        -> std::array<std::uint32_t, 26> {
+        std::array<std::uint32_t, 26> bitset{};
         for (auto const code : alpha_2_codes) {
-            if (code == needle) {
-                return true;
-            }
+            bitset[static_cast<std::size_t>(code[0] - 'A')] |=
+                1u << static_cast<unsigned>(code[1] - 'A');
+        }
+        return bitset;
+    }
+
+    constexpr static auto const alpha_2_bitset = make_alpha_2_bitset();
+
+    /**
+     *  @brief  Interns an alpha-2-code, regardless of its case.
+     *  @param  code    The country code, e.g. "de" or "DE".
+     *  @return The id of the code or 0 if it is not valid.
+     */
+    constexpr static auto intern_alpha_2(std::string_view code) noexcept
+        -> alpha_2_id {
+        if (code.size() != 2) {
+            return 0;
+        }
+        auto const first = alpha_2_letter(code[0]);
+        auto const second = alpha_2_letter(code[1]);
+        if (first < 0 || second < 0 ||
+            ((alpha_2_bitset[static_cast<std::size_t>(first)] >>
+              static_cast<unsigned>(second)) &
+             1u) == 0) {
+            return 0;
+        }
+        return static_cast<alpha_2_id>(first * 26 + second + 1);
+    }
+
+    /**
+     *  @brief  Returns the alpha-2-code of an id in capital letters.
+     *  @param  id  The id returned by intern_alpha_2().
+     *  @return The null-terminated code, empty if the id is 0.
+     */
+    constexpr static auto alpha_2_name(alpha_2_id id) noexcept
+        -> std::array<char, 3> {
+        if (id == 0 || id > 26 * 26) {
+            return {};
         }
-        return false;
+        auto const index = id - 1;
+        return {static_cast<char>('A' + index / 26),
+                static_cast<char>('A' + index % 26), '\0'};
+    }
+
+    static_assert(intern_alpha_2("de") == intern_alpha_2("DE") &&
+                      alpha_2_name(intern_alpha_2("de"))[1] == 'E' &&
+                      intern_alpha_2("d1") == 0,
+                  "alpha-2-code interning is broken!");
+
+    /**
+     *  @brief  Determines whether the given alpha-2-code is valid.
+     *  @param  needle  The country code to be checked, in either case.
+     */
+    constexpr static auto has_alpha_2_code(std::string_view needle) noexcept
+        -> bool {
+        return intern_alpha_2(needle) != 0;
     }
 
     /**
-     *  @brief  Replaces umlauts with their alternative representation.
-     *  @param  str The string to be replaced.
+     *  ASCII folds of the Latin-1 Supplement and Latin Extended-A letters
+     *  U+00C0..U+017F, which are missing from the 5x7 font of the display.
+     *  German umlauts keep their two letter spelling.
      */
-    static void replace_umlauts(std::string &str) {
-        std::unordered_map<std::string, std::string> static const umlauts{
-            {"ä", "ae"}, {"ö", "oe"}, {"ü", "ue"}, {"Ä", "Ae"},
-            {"Ö", "Oe"}, {"Ü", "Ue"}, {"ß", "ss"}};
+    constexpr static char const latin_folds[][3] = {
+        "A",  "A",  "A",  "A",  "Ae", "A",  "AE", "C",  "E",  "E",  "E",  "E",
+        "I",  "I",  "I",  "I",  "D",  "N",  "O",  "O",  "O",  "O",  "Oe", "x",
+        "O",  "U",  "U",  "U",  "Ue", "Y",  "Th", "ss", "a",  "a",  "a",  "a",
+        "ae", "a",  "ae", "c",  "e",  "e",  "e",  "e",  "i",  "i",  "i",  "i",
+        "d",  "n",  "o",  "o",  "o",  "o",  "oe", "/",  "o",  "u",  "u",  "u",
+        "ue", "y",  "th", "y",  "A",  "a",  "A",  "a",  "A",  "a",  "C",  "c",
+        "C",  "c",  "C",  "c",  "C",  "c",  "D",  "d",  "D",  "d",  "E",  "e",
+        "E",  "e",  "E",  "e",  "E",  "e",  "E",  "e",  "G",  "g",  "G",  "g",
+        "G",  "g",  "G",  "g",  "H",  "h",  "H",  "h",  "I",  "i",  "I",  "i",
+        "I",  "i",  "I",  "i",  "I",  "i",  "IJ", "ij", "J",  "j",  "K",  "k",
+        "k",  "L",  "l",  "L",  "l",  "L",  "l",  "L",  "l",  "L",  "l",  "N",
+        "n",  "N",  "n",  "N",  "n",  "n",  "N",  "n",  "O",  "o",  "O",  "o",
+        "O",  "o",  "OE", "oe", "R",  "r",  "R",  "r",  "R",  "r",  "S",  "s",
+        "S",  "s",  "S",  "s",  "S",  "s",  "T",  "t",  "T",  "t",  "T",  "t",
+        "U",  "u",  "U",  "u",  "U",  "u",  "U",  "u",  "U",  "u",  "U",  "u",
+        "W",  "w",  "Y",  "y",  "Y",  "Z",  "z",  "Z",  "z",  "Z",  "z",  "s"};
 
-        for (std::size_t i = 0; i < str.size(); ++i) {
-            for (auto const &[k, v] : umlauts) {
-                auto pos = str.find(k);
-                if (pos != std::string::npos) {
-                    str[pos] = v[0];
-                    str[pos + 1] = v[1];
+    static_assert(sizeof(latin_folds) / sizeof(latin_folds[0]) == 0x180 - 0xC0,
+                  "latin_folds must cover U+00C0..U+017F!");
+
+    /**
+     *  @brief  Returns the ASCII replacement of a non-ASCII code point.
+     *  @param  code_point  The code point.
+     *  @return The replacement or "?" if there is none.
+     */
+    constexpr static auto fold_code_point(std::uint32_t code_point) noexcept
+        -> std::string_view {
+        if (code_point >= 0xC0 && code_point < 0x180) {
+            return latin_folds[code_point - 0xC0];
+        }
+        switch (code_point) {
+            case 0xA0: // no-break space
+                return " ";
+            case 0x2010: // hyphens and dashes
+            case 0x2011:
+            case 0x2012:
+            case 0x2013:
+            case 0x2014:
+                return "-";
+            case 0x2018: // single quotation marks, e.g. in "Cote d'Ivoire"
+            case 0x2019:
+                return "'";
+            case 0x201C: // double quotation marks
+            case 0x201D:
+                return "\"";
+            default:
+                return "?";
+        }
+    }
+
+    /**
+     *  @brief  Transliterates UTF-8 text into the ASCII range of the display
+     *          font in a single pass. Invalid sequences become '?'.
+     *  @param  str     The UTF-8 text.
+     *  @param  out     The buffer to be filled, it is not null-terminated.
+     *  @param  size    The size of the buffer, the text is truncated to it.
+     *  @return The number of characters written.
+     */
+    constexpr static auto transliterate(std::string_view str, char *out,
+                                        std::size_t size) noexcept
+        -> std::size_t {
+        std::size_t length{0};
+        for (std::size_t i = 0; i < str.size() && length < size;) {
+            auto const lead = static_cast<unsigned char>(str[i]);
+            if (lead < 0x80) {
+                out[length++] = static_cast<char>(lead);
+                ++i;
+                continue;
+            }
+            // the sequence length and payload bits of the lead byte
+            std::size_t count{0};
+            std::uint32_t code_point{0};
+            if (lead >= 0xC2 && lead <= 0xDF) {
+                count = 2;
+                code_point = lead & 0x1Fu;
+            } else if (lead >= 0xE0 && lead <= 0xEF) {
+                count = 3;
+                code_point = lead & 0x0Fu;
+            } else if (lead >= 0xF0 && lead <= 0xF4) {
+                count = 4;
+                code_point = lead & 0x07u;
+            }
+            std::size_t n{1};
+            while (n < count && i + n < str.size() &&
+                   (static_cast<unsigned char>(str[i + n]) & 0xC0u) == 0x80u) {
+                code_point = (code_point << 6u) |
+                             (static_cast<unsigned char>(str[i + n]) & 0x3Fu);
+                ++n;
+            }
+            // a stray continuation byte or a truncated sequence
+            auto const fold = n == count ? fold_code_point(code_point)
+                                         : std::string_view{"?"};
+            for (auto const c : fold) {
+                if (length == size) {
+                    break;
                 }
+                out[length++] = c;
+            }
+            i += n;
+        }
+        return length;
+    }
+
+    /**
+     *  @brief  Copies a location into a fixed-size name, transliterated to
+     *          the display font. The name is truncated and always
+     *          null-terminated.
+     *  @param  location    The location, e.g. a view into the JSON buffer.
+     *  @param  name    The name to be filled.
+     */
+    template <std::size_t N>
+    static void copy_name(std::string_view location,
+                          std::array<char, N> &name) noexcept {
+        auto const length = transliterate(location, name.data(), N - 1);
+        name[length] = '\0';
+    }
+
+    constexpr static std::uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+    constexpr static std::uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    /**
+     *  @brief  Continues a 64-bit FNV-1a hash over the given bytes.
+     *  @param  data    The bytes to be hashed.
+     *  @param  size    The number of bytes.
+     *  @param  hash    The hash of the preceding bytes.
+     */
+    constexpr static auto fnv1a(char const *data, std::size_t size,
+                                std::uint64_t hash = FNV_OFFSET_BASIS)
+        -> std::uint64_t {
+        for (std::size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    /**
+     *  @brief  Hashes a location, i.e. its name seeded by its interned
+     *          alpha-2 code, so equal names of different countries spread.
+     *  @param  code    The interned alpha-2 code of the location.
+     *  @param  name    The name of the location.
+     */
+    constexpr static auto location_hash(std::uint16_t code,
+                                        std::string_view name) noexcept
+        -> std::uint64_t {
+        return fnv1a(name.data(), name.size(), FNV_OFFSET_BASIS ^ code);
+    }
+
+    /**
+     *  @brief  Parses a fixed number of decimal digits.
+     *  @param  str The digits.
+     *  @return The value or -1 if any character is not a digit.
+     */
+    constexpr static auto parse_digits(std::string_view str) noexcept
+        -> std::int32_t {
+        std::int32_t value{0};
+        for (auto const c : str) {
+            if (c < '0' || c > '9') {
+                return -1;
             }
+            value = value * 10 + (c - '0');
         }
+        return value;
+    }
+
+    /**
+     *  @brief  Returns the number of days between 1970-01-01 and a date of
+     *          the proleptic Gregorian calendar.
+     */
+    constexpr static auto days_from_civil(std::int64_t year,
+                                          std::int32_t month,
+                                          std::int32_t day) noexcept
+        -> std::int64_t {
+        // years start in March, so the leap day is the last one of a year
+        year -= month <= 2 ? 1 : 0;
+        auto const era = (year >= 0 ? year : year - 399) / 400;
+        auto const year_of_era = year - era * 400;
+        auto const day_of_year =
+            (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        auto const day_of_era = year_of_era * 365 + year_of_era / 4 -
+                                year_of_era / 100 + day_of_year;
+        return era * 146097 + day_of_era - 719468;
     }
 
+    /**
+     *  @brief  Parses a timestamp of the fixed layout used by the API, e.g.
+     *          "2020-05-19 07:15:06.108706+00:00", without going through the
+     *          locale. The fraction and the UTC offset are optional.
+     *  @param  str The timestamp.
+     *  @return The seconds since the epoch or 0 if the layout does not match.
+     */
+    constexpr static auto parse_timestamp(std::string_view str) noexcept
+        -> std::int64_t {
+        // "YYYY-MM-DD HH:MM:SS"
+        constexpr std::size_t DATE_TIME_SIZE = 19;
+        if (str.size() < DATE_TIME_SIZE || str[4] != '-' || str[7] != '-' ||
+            (str[10] != ' ' && str[10] != 'T') || str[13] != ':' ||
+            str[16] != ':') {
+            return 0;
+        }
+        auto const year = parse_digits(str.substr(0, 4));
+        auto const month = parse_digits(str.substr(5, 2));
+        auto const day = parse_digits(str.substr(8, 2));
+        auto const hour = parse_digits(str.substr(11, 2));
+        auto const minute = parse_digits(str.substr(14, 2));
+        auto const second = parse_digits(str.substr(17, 2));
+        if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 ||
+            hour < 0 || hour > 23 || minute < 0 || minute > 59 ||
+            second < 0 || second > 60) {
+            return 0;
+        }
+        auto rest = str.substr(DATE_TIME_SIZE);
+        // the fraction is below the resolution of a page
+        if (!rest.empty() && rest.front() == '.') {
+            std::size_t end{1};
+            while (end < rest.size() && rest[end] >= '0' && rest[end] <= '9') {
+                ++end;
+            }
+            rest.remove_prefix(end);
+        }
+        std::int64_t offset{0};
+        if (rest.size() == 6 && (rest[0] == '+' || rest[0] == '-') &&
+            rest[3] == ':') {
+            auto const offset_hours = parse_digits(rest.substr(1, 2));
+            auto const offset_minutes = parse_digits(rest.substr(4, 2));
+            if (offset_hours < 0 || offset_minutes < 0) {
+                return 0;
+            }
+            offset = (offset_hours * 60 + offset_minutes) * 60;
+            offset = rest[0] == '-' ? -offset : offset;
+        } else if (!rest.empty() && rest != "Z") {
+            return 0;
+        }
+        return days_from_civil(year, month, day) * 86400 + hour * 3600 +
+               minute * 60 + second - offset;
+    }
+
+    static_assert(parse_timestamp("2020-05-19 07:15:06.108706+00:00") ==
+                      1589872506,
+                  "parse_timestamp() is broken!");
+
     /**
      *  @brief  Returns a C++ value from a Json value.
      *  @tparam T   The C++ type to be converted into.
@@ -113,10 +410,10 @@ namespace utils {
      *  @param  default_val A default value to return if the Json value doesn't
      *                      exist.
      */
-    template <typename T>
-    static auto const json_default_val(rapidjson::Value const &val,
+    template <typename T, typename Value = rapidjson::Value>
+    static auto const json_default_val(Value const &val,
                                        T const &default_val) {
-        return val.Is<T>() ? val.Get<T>() : default_val;
+        return val.template Is<T>() ? val.template Get<T>() : default_val;
     };
 } // namespace utils
 
@@ -0,0 +1,82 @@
+#ifndef COVID_PI_WORKER_POOL_H
+#define COVID_PI_WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ *  A fixed set of threads which run the tasks of a batch concurrently. The
+ *  threads are started by the first batch and kept until the pool is
+ *  destroyed, so a batch costs a wake-up instead of a thread per task.
+ */
+class worker_pool final {
+  public:
+    /**
+     *  @brief  Constructor, no thread is started yet.
+     *  @param  threads The number of threads besides the calling one.
+     */
+    explicit worker_pool(std::size_t threads) noexcept;
+
+    /**
+     *  @brief  Destructor, stops and joins the threads.
+     */
+    ~worker_pool();
+
+    worker_pool(worker_pool const &) = delete;
+    worker_pool &operator=(worker_pool const &) = delete;
+
+    /**
+     *  @brief  Returns the number of tasks which run concurrently, including
+     *          the calling thread.
+     */
+    [[nodiscard]] std::size_t size() const noexcept;
+
+    /**
+     *  @brief  Runs a batch of tasks and waits for all of them. The calling
+     *          thread runs tasks as well.
+     *  @param  count   The number of tasks.
+     *  @param  task    Invoked with the index of each task, concurrently.
+     */
+    template <typename Task>
+    void run(std::size_t count, Task &task) {
+        run(
+            count,
+            [](void *context, std::size_t index) {
+                (*static_cast<std::remove_reference_t<Task> *>(context))(
+                    index);
+            },
+            &task);
+    }
+
+  private:
+    // a plain function and its context, type erased without allocating
+    using task_type = void (*)(void *, std::size_t);
+
+    void run(std::size_t count, task_type task, void *context);
+
+    /**
+     *  @brief  The body of each thread, runs tasks until stopped.
+     */
+    void work();
+
+  private:
+    std::size_t thread_count_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    task_type task_{nullptr};
+    void *context_{nullptr};
+    // tasks of the current batch: their number, the next one to be taken
+    // and those not finished yet
+    std::size_t count_{0};
+    std::size_t next_{0};
+    std::size_t pending_{0};
+    bool stop_{false};
+};
+
+#endif // COVID_PI_WORKER_POOL_H
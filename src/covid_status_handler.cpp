@@ -1,169 +1,386 @@
 #include <include/covid_status_handler.h>
 #include <include/io/oled_display.h>
+#include <include/io/snapshot.h>
+#include <include/io/status_leds.h>
 #include <include/utils.h>
 
-#include <future>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
 #include <mutex>
-
-#include <rapidjson/document.h>
-#include <rapidjson/error/en.h>
+#include <unordered_map>
 
 #include <curl/curl.h>
 
+namespace {
+    /**
+     *  Identifies the same location across providers. Refers to the name of a
+     *  record which outlives the merge.
+     */
+    struct location_key final {
+        std::uint16_t code;
+        std::string_view name;
+
+        bool operator==(location_key const &other) const noexcept {
+            return code == other.code && name == other.name;
+        }
+    };
+
+    struct location_hash final {
+        std::size_t operator()(location_key const &key) const noexcept {
+            return static_cast<std::size_t>(
+                utils::location_hash(key.code, key.name));
+        }
+    };
+} // namespace
+
 /**
- * @brief   The callback for writing received data.
- * @return  Returns the number of bytes written to data.
+ * @brief   Adds two counts, saturating at the range of a count instead of
+ *          overflowing.
  */
-static size_t write_callback(char *ptr, size_t size, size_t nmemb,
-                             void *userdata) {
-    reinterpret_cast<std::string *>(userdata)->append(ptr, size * nmemb);
-    return size * nmemb;
+static std::int32_t saturating_add(std::int32_t lhs,
+                                   std::int32_t rhs) noexcept {
+    auto const sum = static_cast<std::int64_t>(lhs) + rhs;
+    return static_cast<std::int32_t>(
+        std::clamp<std::int64_t>(sum, std::numeric_limits<std::int32_t>::min(),
+                                 std::numeric_limits<std::int32_t>::max()));
+}
+
+/**
+ * @brief   Merges the counts of a record into those of the same location.
+ * @param   into    The record delivered by a previous provider.
+ * @param   from    The record of the provider being merged.
+ * @param   policy  The merge policy of the provider being merged.
+ */
+static void merge_counts(covid_data &into, covid_data const &from,
+                         MergePolicy policy) noexcept {
+    switch (policy) {
+        case MergePolicy::Max:
+            into.confirmed = std::max(into.confirmed, from.confirmed);
+            into.dead = std::max(into.dead, from.dead);
+            into.recovered = std::max(into.recovered, from.recovered);
+            break;
+        case MergePolicy::Sum:
+            into.confirmed = saturating_add(into.confirmed, from.confirmed);
+            into.dead = saturating_add(into.dead, from.dead);
+            into.recovered = saturating_add(into.recovered, from.recovered);
+            break;
+        case MergePolicy::Override:
+            into.confirmed = from.confirmed;
+            into.dead = from.dead;
+            into.recovered = from.recovered;
+            break;
+    }
+    into.updated = std::max(into.updated, from.updated);
 }
 
 covid_status_handler::covid_status_handler(io::menu &menu,
                                            io::input_handler &input_handler,
+                                           net::fetcher &fetcher,
                                            std::string_view country,
                                            SortFunction &&sort_fun)
-    : menu_(menu), input_handler_(input_handler), country_(country),
-      sort_fun_(std::move(sort_fun)) {
-    curl_global_init(CURL_GLOBAL_ALL);
-    handle_ = curl_easy_init();
-    // pre-allocate 40KB
-    json_data_.reserve(4096 * 10);
+    : menu_(menu), input_handler_(input_handler), fetcher_(fetcher),
+      country_(country), sort_fun_(std::move(sort_fun)) {
+    sources_.emplace_back(std::make_unique<data_source>(
+        providers::trackcorona(api_type_), country_));
 }
 
-covid_status_handler::~covid_status_handler() {
-    curl_easy_cleanup(handle_);
-    curl_global_cleanup();
+void covid_status_handler::set_mode(APIType api_type) {
+    assert(api_type <= 1 && api_type >= 0 && "APIType out of range!");
+    sources_.front() = std::make_unique<data_source>(
+        providers::trackcorona(api_type), country_);
+    api_type_ = api_type;
 }
 
-void covid_status_handler::set_mode(APIType api_type) noexcept {
-    assert(api_type <= 1 && api_type >= 0 && "APIType out of range!");
-    curl_easy_setopt(handle_, CURLOPT_URL, apis[api_type]);
+void covid_status_handler::add_provider(provider source) {
+    sources_.emplace_back(
+        std::make_unique<data_source>(std::move(source), country_));
+}
+
+void covid_status_handler::set_url(std::string const &url) noexcept {
+    sources_.front()->set_url(url);
+}
+
+void covid_status_handler::set_max_recv_speed(
+    std::int64_t bytes_per_second) noexcept {
+    for (auto &&source : sources_) {
+        source->set_max_recv_speed(bytes_per_second);
+    }
+}
+
+void covid_status_handler::set_chunk_size(long bytes) noexcept {
+    for (auto &&source : sources_) {
+        source->set_chunk_size(bytes);
+    }
 }
 
 void covid_status_handler::set_timeout(long timeout) noexcept {
-    curl_easy_setopt(handle_, CURLOPT_TIMEOUT, timeout);
+    for (auto &&source : sources_) {
+        source->set_timeout(timeout);
+    }
 }
 
-bool covid_status_handler::setup() noexcept {
-    if (handle_ == nullptr) {
+void covid_status_handler::set_max_body_size(std::size_t bytes) noexcept {
+    for (auto &&source : sources_) {
+        source->set_max_body_size(bytes);
+    }
+}
+
+void covid_status_handler::set_snapshot_path(std::string path) noexcept {
+    snapshot_path_ = std::move(path);
+}
+
+void covid_status_handler::set_history(std::size_t max_bytes,
+                                       std::size_t depth) {
+    history_ = history{max_bytes, depth};
+}
+
+void covid_status_handler::set_history_path(std::string path) noexcept {
+    history_path_ = std::move(path);
+}
+
+void covid_status_handler::set_movers(std::size_t count) {
+    movers_ = movers{count};
+}
+
+bool covid_status_handler::restore_history() {
+    if (history_path_.empty() ||
+        !history_file_.open(history_path_, api_type_, country_)) {
         return false;
     }
-    curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(handle_, CURLOPT_WRITEDATA, &json_data_);
-    curl_easy_setopt(handle_, CURLOPT_USERAGENT, "covid-pi/1.0");
+    // each ring keeps the newest samples of its location
+    static_cast<void>(history_file_.scan(
+        std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::int64_t>::max(),
+        [this](auto code, auto name, auto const &value) {
+            static_cast<void>(history_.append(code, name, value));
+        }));
     return true;
 }
 
-bool covid_status_handler::request() noexcept {
-    json_data_.clear();
-    auto const res = curl_easy_perform(handle_);
-    if (res != CURLE_OK) {
-        fmt::print(stderr, "curl_easy_perform() failed: {}\n",
-                   curl_easy_strerror(res));
+bool covid_status_handler::restore_snapshot() {
+    io::menu::pages_type pages{};
+    if (snapshot_path_.empty() ||
+        !io::snapshot::load(snapshot_path_, api_type_, country_, pages) ||
+        pages.empty()) {
         return false;
     }
-    return handle_data_received();
+    // the sort order may have changed since the snapshot was taken
+    pages.sort(sort_fun_);
+    publish(std::move(pages));
+    return true;
 }
 
-bool covid_status_handler::async_request() {
-    using namespace std::literals::chrono_literals;
+void covid_status_handler::set_parse_mode(ParseMode parse_mode) noexcept {
+    for (auto &&source : sources_) {
+        source->set_parse_mode(parse_mode);
+    }
+}
+
+void covid_status_handler::set_validation(bool validate) {
+    for (auto &&source : sources_) {
+        source->set_validation(validate);
+    }
+}
+
+bool covid_status_handler::setup() noexcept {
+    return std::all_of(std::begin(sources_), std::end(sources_),
+                       [](auto &&source) { return source->setup(); });
+}
 
-    json_data_.clear();
-    auto task = std::async(std::launch::async, [this]() -> bool {
-        assert(handle_ && "curl handle is NULL!\n");
-        auto const res = curl_easy_perform(handle_);
+bool covid_status_handler::request() noexcept {
+    sort_time_ = publish_time_ = {};
+    pending_ = sources_.size();
+    bool result{false};
+    for (auto &&source : sources_) {
+        auto const res = curl_easy_perform(source->prepare_request());
         if (res != CURLE_OK) {
             fmt::print(stderr, "curl_easy_perform() failed: {}\n",
                        curl_easy_strerror(res));
-            return false;
-        }
-        return true;
-    });
-    // poll the status and perform parallel work
-    std::future_status status;
-    bool toggle{false};
-    do {
-        // toggle the LEDs every 250ms
-        status = task.wait_for(250ms);
-        if (status == std::future_status::timeout) {
-            // do some parallel work here
-            // toggle the LEDs
-            toggle = !toggle;
-            if (toggle) {
-                digitalWrite(io::gpio_pins::LED_GREEN, HIGH);
-                digitalWrite(io::gpio_pins::LED_RED, LOW);
-            } else {
-                digitalWrite(io::gpio_pins::LED_GREEN, LOW);
-                digitalWrite(io::gpio_pins::LED_RED, HIGH);
-            }
         }
-    } while (status != std::future_status::ready);
-
-    return task.get() && handle_data_received();
+        // evaluate every provider, even if a previous one failed
+        result = handle_data_received(*source, res == CURLE_OK) || result;
+    }
+    return result;
 }
 
-bool covid_status_handler::handle_data_received() {
-    using namespace rapidjson;
-
-    Document d;
-    ParseResult const ok = d.Parse(json_data_.c_str());
-    if (!ok) {
-        fmt::print(stderr, "JSON parse error: {} ({})",
-                   GetParseError_En(ok.Code()), ok.Offset());
-        return false;
+bool covid_status_handler::start_request() {
+    sort_time_ = publish_time_ = {};
+    result_ = false;
+    pending_ = 0;
+    for (auto &&source : sources_) {
+        auto &self = *source;
+        if (fetcher_.add(self.prepare_request(), [this, &self](bool ok) {
+                result_ = handle_data_received(self, ok) || result_;
+            })) {
+            ++pending_;
+        }
     }
+    return pending_ > 0;
+}
 
-    io::menu::pages_type pages{};
-    pages.reserve(d["data"].GetArray().Size());
+bool covid_status_handler::async_request() {
+    return start_request() && fetcher_.run() && result_;
+}
 
-    // move data from json document into covid_status vector
-    for (auto &&e : d["data"].GetArray()) {
-        using namespace utils;
+covid_status_handler::statistics covid_status_handler::stats() const noexcept {
+    statistics total{};
+    for (auto &&source : sources_) {
+        auto const &stats = source->stats();
+        total.requests += stats.requests;
+        total.not_modified += stats.not_modified;
+        total.unchanged += stats.unchanged;
+        total.bytes_received += stats.bytes_received;
+        total.bytes_on_wire += stats.bytes_on_wire;
+        total.bytes_saved += stats.bytes_saved;
+        total.reused_connections += stats.reused_connections;
+    }
+    if (last_source_ != nullptr) {
+        auto const &stats = last_source_->stats();
+        total.last_bytes_on_wire = stats.last_bytes_on_wire;
+        total.last_bytes_decoded = stats.last_bytes_decoded;
+        total.last_parse_allocations = stats.last_parse_allocations;
+        total.last_timings = stats.last_timings;
+    }
+    total.last_timings.sort = sort_time_;
+    total.last_timings.publish = publish_time_;
+    return total;
+}
 
-        auto page = std::make_unique<covid_data>();
-        auto const &code = e["country_code"].Move().GetString();
-        // filter by country if given
-        if (!country_.empty() && code != country_) {
-            continue;
+std::chrono::seconds covid_status_handler::freshness() const noexcept {
+    std::chrono::seconds freshness{};
+    for (auto &&source : sources_) {
+        auto const lifetime = source->freshness();
+        // a provider without a lifetime must not be refreshed any later
+        if (lifetime.count() == 0) {
+            return lifetime;
+        }
+        if (freshness.count() == 0 || lifetime < freshness) {
+            freshness = lifetime;
         }
+    }
+    return freshness;
+}
 
-        auto &&loc = std::string{e["location"].Move().GetString()};
-        replace_umlauts(loc);
+bool covid_status_handler::data_changed() const noexcept {
+    return std::any_of(std::begin(sources_), std::end(sources_),
+                       [](auto &&source) { return source->data_changed(); });
+}
 
-        auto const &confirmed =
-            json_default_val<std::int32_t>(e["confirmed"], 0);
-        auto const &dead = json_default_val<std::int32_t>(e["dead"], 0);
-        auto const &recovered =
-            json_default_val<std::int32_t>(e["recovered"], 0);
-        std::copy_n(std::begin(loc), page->name.max_size() - 1,
-                    std::begin(page->name));
-        std::copy_n(code, page->code.max_size() - 1, std::begin(page->code));
-        page->confirmed = confirmed;
-        page->dead = dead;
-        page->recovered = recovered;
+bool covid_status_handler::handle_data_received(data_source &source,
+                                                bool ok) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    using std::chrono::steady_clock;
 
-        pages.emplace_back(std::move(page));
+    last_source_ = &source;
+    if (pending_ > 0 && --pending_ == 0) {
+        io::status_leds::off();
+    }
+    if (!ok || !source.finish()) {
+        fmt::print(stderr, "refreshing from {} failed\n", source.name());
+        return false;
+    }
+    // a 304 or an identical body, the published pages are still up to date
+    if (!source.modified()) {
+        return true;
     }
+
+    // a single provider needs no merge, its records are handed over as is
+    auto pages = sources_.size() == 1 ? std::move(source.pages()) : merge();
     if (pages.empty()) {
         fmt::print(stderr, "Country with code {} has no registered cities!\n",
                    country_);
         return false;
     }
-    std::sort(std::begin(pages), std::end(pages), sort_fun_);
+    auto const sort_start = steady_clock::now();
+    pages.sort(sort_fun_);
+    sort_time_ = duration_cast<microseconds>(steady_clock::now() - sort_start);
+    auto const now = duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch())
+                         .count();
+    history_.record(pages, now);
+    if (history_file_.is_open() || movers_.count() > 0) {
+        // compared with the pages published last, which is the previous
+        // refresh or the snapshot restored at boot
+        static io::menu::pages_type const none{};
+        auto const previous = menu_.pages();
+        auto top = movers_.update(previous != nullptr ? *previous : none,
+                                  pages);
+        if (history_file_.is_open()) {
+            append_history(pages, now);
+        }
+        if (movers_.count() > 0) {
+            menu_.add_movers(std::move(top));
+        }
+    }
+    if (!snapshot_path_.empty()) {
+        // a failed snapshot only costs the warm start after the next boot
+        static_cast<void>(
+            io::snapshot::save(snapshot_path_, api_type_, country_, pages));
+    }
+    auto const publish_start = steady_clock::now();
+    publish(std::move(pages));
+    publish_time_ =
+        duration_cast<microseconds>(steady_clock::now() - publish_start);
+    return true;
+}
+
+void covid_status_handler::append_history(io::menu::pages_type const &pages,
+                                          std::int64_t now) {
+    // only the changed records are appended, no matter how many locations
+    // the history keeps in memory
+    auto const &deltas = movers_.deltas();
+    history_file_.begin(now);
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+        if (deltas[i].changed) {
+            auto const page = pages[i];
+            history_file_.add(page.code(), page.name(),
+                              history::to_sample(page, now));
+        }
+    }
+    // a failed append only costs the history after the next boot
+    static_cast<void>(history_file_.commit());
+}
+
+io::menu::pages_type covid_status_handler::merge() const {
+    io::menu::pages_type merged{};
+    std::unordered_map<location_key, std::size_t, location_hash> index{};
+    merged.reserve(sources_.front()->pages().size());
+    index.reserve(sources_.front()->pages().size());
+
+    for (auto &&source : sources_) {
+        // records of the same provider are never merged with each other
+        auto const merged_before = merged.size();
+        auto const &pages = source->pages();
+        for (std::size_t i = 0; i < pages.size(); ++i) {
+            auto const page = pages[i];
+            location_key const key{page.code(), page.name()};
+            auto const it = index.find(key);
+            if (it != std::end(index) && it->second < merged_before) {
+                auto record = merged[it->second].record();
+                merge_counts(record, page.record(), source->merge_policy());
+                merged.set_counts(it->second, record);
+                continue;
+            }
+            if (it == std::end(index)) {
+                index.emplace(key, merged.size());
+            }
+            merged.push_back(page.record());
+        }
+    }
+    return merged;
+}
+
+void covid_status_handler::publish(io::menu::pages_type &&pages) {
+    // swapped in without a lock, the input handler thread renders the pages
+    // while the next refresh is already running
+    menu_.add_menu(std::move(pages));
     {
-        // put input handler thread to sleep until data from mainthread is
-        // ready.
+        // wake up the input handler thread once the first pages are ready
         std::lock_guard<std::mutex> lk(input_handler_.mutex());
-        input_handler_.ready(false);
-        menu_.add_menu(std::move(pages));
         input_handler_.ready(true);
     }
     input_handler_.cv().notify_one();
-
-    // turn off the status LEDs
-    digitalWrite(io::gpio_pins::LED_GREEN, LOW);
-    digitalWrite(io::gpio_pins::LED_RED, LOW);
-    return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,587 @@
+#include <include/data_source.h>
+#include <include/io/status_leds.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <ctime>
+#include <optional>
+#include <thread>
+
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+
+#include <fmt/format.h>
+
+/**
+ * @brief   Extracts the value of a header line if its name matches.
+ * @param   line    The raw header line including the trailing CRLF.
+ * @param   name    The case-insensitive header name.
+ * @return  The trimmed header value if the header name matches.
+ */
+static std::optional<std::string_view> header_value(std::string_view line,
+                                                    std::string_view name) {
+    if (line.size() <= name.size() || line[name.size()] != ':') {
+        return std::nullopt;
+    }
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(line[i])) !=
+            std::tolower(static_cast<unsigned char>(name[i]))) {
+            return std::nullopt;
+        }
+    }
+    line.remove_prefix(name.size() + 1);
+    auto const first = line.find_first_not_of(" \t");
+    auto const last = line.find_last_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return std::string_view{};
+    }
+    return line.substr(first, last - first + 1);
+}
+
+/**
+ * @brief   Extracts the freshness lifetime of a Cache-Control header.
+ * @param   value   The header value, e.g. "public, max-age=600".
+ * @return  The max-age in seconds, 0 if the response must not be cached or
+ *          -1 if there is no such directive.
+ */
+static long cache_control_max_age(std::string_view value) {
+    if (value.find("no-cache") != std::string_view::npos ||
+        value.find("no-store") != std::string_view::npos) {
+        return 0;
+    }
+    constexpr std::string_view directive{"max-age="};
+    auto const pos = value.find(directive);
+    if (pos == std::string_view::npos) {
+        return -1;
+    }
+    value.remove_prefix(pos + directive.size());
+    long max_age{-1};
+    std::from_chars(value.data(), value.data() + value.size(), max_age);
+    return max_age;
+}
+
+/**
+ * @brief   Parses an HTTP date such as the Expires or Date header.
+ * @return  The time in seconds since the epoch or -1 if invalid.
+ */
+static std::time_t http_date(std::string_view value) {
+    return curl_getdate(std::string{value}.c_str(), nullptr);
+}
+
+/**
+ * @brief   Determines whether a Content-Type header denotes a JSON document.
+ *          Plain text is accepted as well, e.g. for a file served locally.
+ */
+static bool is_json_content_type(std::string_view value) {
+    std::string type{value.substr(0, value.find(';'))};
+    std::transform(std::begin(type), std::end(type), std::begin(type),
+                   [](unsigned char c) { return std::tolower(c); });
+    return type.find("json") != std::string::npos ||
+           type.rfind("text/plain", 0) == 0;
+}
+
+/**
+ * @brief   Looks up a member of a JSON object.
+ * @return  The member value or nullptr if there is no such member.
+ */
+template <typename Value>
+static Value const *find_member(Value const &object, std::string_view name) {
+    if (!object.IsObject()) {
+        return nullptr;
+    }
+    Value const key{rapidjson::StringRef(
+        name.data(), static_cast<rapidjson::SizeType>(name.size()))};
+    auto const it = object.FindMember(key);
+    return it != object.MemberEnd() ? &it->value : nullptr;
+}
+
+std::size_t data_source::write_callback(char *ptr, std::size_t size,
+                                        std::size_t nmemb, void *userdata) {
+    auto *const self = reinterpret_cast<data_source *>(userdata);
+    auto const bytes = size * nmemb;
+    if (!self->body_checked_ && !self->check_response(ptr, bytes)) {
+        return 0;
+    }
+    if (self->body_size_ + bytes > self->max_body_size_) {
+        fmt::print(stderr, "{}: response exceeds {} bytes, aborting\n",
+                   self->provider_.name, self->max_body_size_);
+        return 0;
+    }
+    self->body_hash_ = utils::fnv1a(ptr, bytes, self->body_hash_);
+    self->body_size_ += bytes;
+    if (self->parse_mode_ == ParseMode::Stream) {
+        auto const start = std::chrono::steady_clock::now();
+        auto const ok = self->stream_parser_.feed(ptr, bytes);
+        self->parse_time_ += std::chrono::steady_clock::now() - start;
+        return ok ? bytes : 0;
+    }
+    self->body_.append(ptr, bytes);
+    return bytes;
+}
+
+std::size_t data_source::header_callback(char *buffer, std::size_t size,
+                                         std::size_t nitems, void *userdata) {
+    auto *const self = reinterpret_cast<data_source *>(userdata);
+    auto const bytes = size * nitems;
+    std::string_view const line{buffer, bytes};
+    // a status line starts a new response, e.g. after a redirect
+    if (line.rfind("HTTP/", 0) == 0) {
+        self->response_etag_.clear();
+        self->response_last_modified_.clear();
+        self->response_max_age_ = -1;
+        self->response_expires_ = -1;
+        self->response_date_ = -1;
+    } else if (auto const etag = header_value(line, "ETag")) {
+        self->response_etag_ = *etag;
+    } else if (auto const modified = header_value(line, "Last-Modified")) {
+        self->response_last_modified_ = *modified;
+    } else if (auto const cache = header_value(line, "Cache-Control")) {
+        self->response_max_age_ = cache_control_max_age(*cache);
+    } else if (auto const expires = header_value(line, "Expires")) {
+        self->response_expires_ = http_date(*expires);
+    } else if (auto const date = header_value(line, "Date")) {
+        self->response_date_ = http_date(*date);
+    }
+    return bytes;
+}
+
+int data_source::progress_callback(void *, std::int64_t, std::int64_t,
+                                   std::int64_t, std::int64_t) {
+    io::status_leds::tick();
+    return 0;
+}
+
+data_source::data_source(provider source, std::string_view country)
+    : provider_(std::move(source)), country_(country),
+      country_code_(utils::intern_alpha_2(country)),
+      stream_parser_(country, provider_.schema),
+      document_handler_(country, provider_.schema),
+      workers_(std::max(std::thread::hardware_concurrency(), 1U) - 1),
+      parallel_parser_(country, provider_.schema, workers_),
+      validator_(provider_.schema) {
+    set_validation(true);
+    curl_global_init(CURL_GLOBAL_ALL);
+    handle_ = curl_easy_init();
+    if (handle_ != nullptr) {
+        curl_easy_setopt(handle_, CURLOPT_URL, provider_.url.c_str());
+    }
+}
+
+data_source::~data_source() {
+    curl_slist_free_all(request_headers_);
+    curl_easy_cleanup(handle_);
+    curl_global_cleanup();
+}
+
+std::string const &data_source::name() const noexcept {
+    return provider_.name;
+}
+
+MergePolicy data_source::merge_policy() const noexcept {
+    return provider_.merge;
+}
+
+void data_source::set_url(std::string const &url) noexcept {
+    provider_.url = url;
+    curl_easy_setopt(handle_, CURLOPT_URL, provider_.url.c_str());
+    // the validators belong to the previous URL
+    etag_.clear();
+    last_modified_.clear();
+    last_body_hash_ = 0;
+    last_body_size_ = 0;
+}
+
+void data_source::set_max_recv_speed(std::int64_t bytes_per_second) noexcept {
+    curl_easy_setopt(handle_, CURLOPT_MAX_RECV_SPEED_LARGE,
+                     static_cast<curl_off_t>(bytes_per_second));
+}
+
+void data_source::set_chunk_size(long bytes) noexcept {
+    curl_easy_setopt(handle_, CURLOPT_BUFFERSIZE, bytes);
+}
+
+void data_source::set_timeout(long timeout) noexcept {
+    curl_easy_setopt(handle_, CURLOPT_TIMEOUT, timeout);
+}
+
+void data_source::set_max_body_size(std::size_t bytes) noexcept {
+    max_body_size_ = bytes;
+    // lets curl fail right away if the Content-Length is already too large,
+    // the write callback still guards chunked and compressed bodies
+    curl_easy_setopt(handle_, CURLOPT_MAXFILESIZE_LARGE,
+                     static_cast<curl_off_t>(bytes));
+}
+
+void data_source::set_parse_mode(ParseMode parse_mode) noexcept {
+    // splitting the parse only pays off with a core per slice, e.g. not on
+    // the Pi Zero, where the stream mode overlaps parsing with the transfer
+    if (parse_mode == ParseMode::Parallel &&
+        std::thread::hardware_concurrency() <= 1) {
+        parse_mode = ParseMode::Stream;
+    }
+    parse_mode_ = parse_mode;
+}
+
+void data_source::set_validation(bool validate) {
+    validate_ = validate;
+    auto const *const record_schema =
+        validate_ ? &validator_.record() : nullptr;
+    stream_parser_.set_validation(record_schema);
+    parallel_parser_.set_validation(record_schema);
+    document_handler_.require_members(validate_);
+    dom_validator_.reset();
+    sax_validator_.reset();
+    if (validate_) {
+        dom_validator_ = std::make_unique<
+            json::schema_validator<rapidjson::BaseReaderHandler<>>>(
+            validator_.document());
+        sax_validator_ =
+            std::make_unique<json::schema_validator<json::document_handler>>(
+                validator_.document(), document_handler_);
+    }
+}
+
+bool data_source::setup() noexcept {
+    if (handle_ == nullptr) {
+        return false;
+    }
+    set_max_body_size(max_body_size_);
+    curl_easy_setopt(handle_, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(handle_, CURLOPT_WRITEDATA, this);
+    curl_easy_setopt(handle_, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(handle_, CURLOPT_HEADERDATA, this);
+    curl_easy_setopt(handle_, CURLOPT_XFERINFOFUNCTION, progress_callback);
+    curl_easy_setopt(handle_, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(handle_, CURLOPT_USERAGENT, "covid-pi/1.0");
+    // offer all encodings supported by libcurl (gzip, deflate), the body is
+    // then decoded chunk by chunk before it reaches the write callback
+    curl_easy_setopt(handle_, CURLOPT_ACCEPT_ENCODING, "");
+    // keep the connection alive between refresh cycles and resume the TLS
+    // session if the server closed it anyway
+    curl_easy_setopt(handle_, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle_, CURLOPT_MAXAGE_CONN, CONNECTION_MAX_AGE);
+    curl_easy_setopt(handle_, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+    curl_easy_setopt(handle_, CURLOPT_DNS_CACHE_TIMEOUT, DNS_CACHE_TIMEOUT);
+    return true;
+}
+
+CURL *data_source::prepare_request() noexcept {
+    // the stream parser already allocates while the body is received
+    allocations_before_ = json::counting_allocator::allocations();
+    body_.clear();
+    body_checked_ = false;
+    stream_parser_.reset();
+    parse_time_ = {};
+    body_hash_ = utils::FNV_OFFSET_BASIS;
+    body_size_ = 0;
+    response_etag_.clear();
+    response_last_modified_.clear();
+    response_max_age_ = -1;
+    response_expires_ = -1;
+    response_date_ = -1;
+    modified_ = false;
+    data_changed_ = false;
+
+    curl_slist_free_all(request_headers_);
+    request_headers_ = nullptr;
+    if (!etag_.empty()) {
+        request_headers_ = curl_slist_append(
+            request_headers_, fmt::format("If-None-Match: {}", etag_).c_str());
+    }
+    if (!last_modified_.empty()) {
+        request_headers_ = curl_slist_append(
+            request_headers_,
+            fmt::format("If-Modified-Since: {}", last_modified_).c_str());
+    }
+    curl_easy_setopt(handle_, CURLOPT_HTTPHEADER, request_headers_);
+    return handle_;
+}
+
+bool data_source::finish() {
+    update_stats();
+    auto const count_allocations = [this]() {
+        stats_.last_parse_allocations =
+            json::counting_allocator::allocations() - allocations_before_;
+    };
+    long response_code{};
+    curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &response_code);
+
+    // nothing changed upstream, keep the current pages
+    if (response_code == 304) {
+        ++stats_.not_modified;
+        stats_.bytes_saved += last_body_size_;
+        if (!response_etag_.empty()) {
+            etag_ = response_etag_;
+        }
+        count_allocations();
+        return true;
+    }
+    // the same body again, the stream parser has already parsed it, which
+    // is dropped with the next request
+    if (body_size_ == last_body_size_ && body_hash_ == last_body_hash_) {
+        ++stats_.unchanged;
+        etag_ = response_etag_;
+        last_modified_ = response_last_modified_;
+        count_allocations();
+        return true;
+    }
+
+    io::menu::pages_type pages{};
+    std::int64_t latest_update{};
+    auto const parse_start = std::chrono::steady_clock::now();
+    if (parse_mode_ == ParseMode::Stream) {
+        if (!stream_parser_.finish()) {
+            fmt::print(stderr, "JSON parse error: incomplete document\n");
+            return false;
+        }
+        pages = std::move(stream_parser_.pages());
+        latest_update = stream_parser_.latest_update();
+    } else if (parse_mode_ == ParseMode::Parallel) {
+        if (!parallel_parser_.parse(body_)) {
+            return false;
+        }
+        pages = std::move(parallel_parser_.pages());
+        latest_update = parallel_parser_.latest_update();
+    } else if (parse_mode_ == ParseMode::Sax) {
+        if (!parse_sax(pages, latest_update)) {
+            return false;
+        }
+    } else if (!parse_dom(pages, latest_update)) {
+        return false;
+    }
+    parse_time_ += std::chrono::steady_clock::now() - parse_start;
+    stats_.last_timings.parse =
+        std::chrono::duration_cast<std::chrono::microseconds>(parse_time_);
+    count_allocations();
+    pages_ = std::move(pages);
+    modified_ = true;
+
+    // remember the parsed response for the next conditional request
+    etag_ = response_etag_;
+    last_modified_ = response_last_modified_;
+    last_body_hash_ = body_hash_;
+    last_body_size_ = body_size_;
+    // a new body alone may only be a reformatted one, the data itself changed
+    // if any record has a newer timestamp
+    data_changed_ = latest_update != latest_update_;
+    latest_update_ = latest_update;
+    return true;
+}
+
+bool data_source::modified() const noexcept {
+    return modified_;
+}
+
+io::menu::pages_type &data_source::pages() noexcept {
+    return pages_;
+}
+
+data_source::statistics const &data_source::stats() const noexcept {
+    return stats_;
+}
+
+std::chrono::seconds data_source::freshness() const noexcept {
+    // max-age takes precedence over Expires
+    if (response_max_age_ >= 0) {
+        return std::chrono::seconds{response_max_age_};
+    }
+    if (response_expires_ >= 0) {
+        auto const date =
+            response_date_ >= 0 ? response_date_ : std::time(nullptr);
+        return std::chrono::seconds{
+            std::max<std::time_t>(response_expires_ - date, 0)};
+    }
+    return std::chrono::seconds{};
+}
+
+bool data_source::data_changed() const noexcept {
+    return data_changed_;
+}
+
+bool data_source::check_response(char const *data, std::size_t size) {
+    long response_code{};
+    curl_easy_getinfo(handle_, CURLINFO_RESPONSE_CODE, &response_code);
+    // e.g. an error page, file:// transfers report 0
+    if (response_code >= 300) {
+        fmt::print(stderr, "{}: unexpected HTTP status {}, aborting\n",
+                   provider_.name, response_code);
+        return false;
+    }
+    char *content_type{nullptr};
+    curl_easy_getinfo(handle_, CURLINFO_CONTENT_TYPE, &content_type);
+    // e.g. the login page of a captive portal
+    if (content_type != nullptr && !is_json_content_type(content_type)) {
+        fmt::print(stderr, "{}: unexpected content type {}, aborting\n",
+                   provider_.name, content_type);
+        return false;
+    }
+    std::string_view const chunk{data, size};
+    auto const first = chunk.find_first_not_of(" \t\r\n");
+    // only whitespace so far, check the next chunk
+    if (first == std::string_view::npos) {
+        return true;
+    }
+    if (chunk[first] != '{') {
+        fmt::print(stderr, "{}: response is not a JSON object, aborting\n",
+                   provider_.name);
+        return false;
+    }
+    body_checked_ = true;
+    return true;
+}
+
+void data_source::update_stats() noexcept {
+    curl_off_t wire_bytes{};
+    curl_easy_getinfo(handle_, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+    ++stats_.requests;
+    stats_.bytes_received += body_size_;
+    stats_.bytes_on_wire += static_cast<std::uint64_t>(wire_bytes);
+    stats_.last_bytes_on_wire = static_cast<std::uint64_t>(wire_bytes);
+    stats_.last_bytes_decoded = body_size_;
+
+    long new_connections{};
+    curl_easy_getinfo(handle_, CURLINFO_NUM_CONNECTS, &new_connections);
+    if (new_connections == 0) {
+        ++stats_.reused_connections;
+    }
+
+    // curl reports the time from the start until the end of each phase
+    curl_off_t dns{}, connect{}, tls{}, first_byte{}, total{};
+    curl_easy_getinfo(handle_, CURLINFO_NAMELOOKUP_TIME_T, &dns);
+    curl_easy_getinfo(handle_, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(handle_, CURLINFO_APPCONNECT_TIME_T, &tls);
+    curl_easy_getinfo(handle_, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+    curl_easy_getinfo(handle_, CURLINFO_TOTAL_TIME_T, &total);
+    auto const phase = [](curl_off_t end, curl_off_t begin) {
+        return std::chrono::microseconds{end > begin ? end - begin : 0};
+    };
+    auto const established = std::max(connect, tls);
+    stats_.last_timings = timings{phase(dns, 0), phase(connect, dns),
+                                  tls > 0 ? phase(tls, connect)
+                                          : std::chrono::microseconds{},
+                                  phase(first_byte, established),
+                                  phase(total, 0)};
+}
+
+bool data_source::parse_dom(io::menu::pages_type &pages,
+                            std::int64_t &latest_update) {
+    using namespace rapidjson;
+
+    using document =
+        GenericDocument<UTF8<>, json::pool_allocator, json::pool_allocator>;
+
+    auto const &keys = provider_.schema;
+    auto values = value_arena_.allocator(json_allocator_);
+    auto stack = stack_arena_.allocator(json_allocator_);
+    document d{&values, STACK_ARENA_SIZE / 2, &stack};
+    net::chunk_list::reader stream{body_};
+    ParseResult const ok = d.ParseStream(stream);
+    // walking the document does not allocate from the arenas anymore
+    value_arena_.record(values);
+    stack_arena_.record(stack);
+    if (!ok) {
+        fmt::print(stderr, "JSON parse error: {} ({})",
+                   GetParseError_En(ok.Code()), ok.Offset());
+        return false;
+    }
+    if (validate_) {
+        dom_validator_->Reset();
+        if (!d.Accept(*dom_validator_)) {
+            json::validator::print_error(*dom_validator_);
+            return false;
+        }
+    }
+    auto const *const records =
+        find_member<document::ValueType>(d, keys.records);
+    if (records == nullptr || !records->IsArray()) {
+        fmt::print(stderr, "JSON parse error: no \"{}\" array ({})\n",
+                   keys.records, provider_.name);
+        return false;
+    }
+
+    // a filter keeps a small fraction of the records
+    if (country_code_ == 0) {
+        pages.reserve(records->Size());
+    }
+
+    // move data from json document into covid_status vector
+    for (auto &&e : records->GetArray()) {
+        using namespace utils;
+
+        auto const string_member = [&e](std::string_view name) {
+            auto const *const value = find_member(e, name);
+            return value != nullptr && value->IsString()
+                       ? std::string_view{value->GetString(),
+                                          value->GetStringLength()}
+                       : std::string_view{};
+        };
+        auto const count_member = [&e](std::string_view name) {
+            auto const *const value = find_member(e, name);
+            return value != nullptr ? json_default_val<std::int32_t>(*value, 0)
+                                    : 0;
+        };
+
+        // required by the schema, see record_handler::require_members()
+        if (validate_ && (find_member(e, keys.location) == nullptr ||
+                          find_member(e, keys.country_code) == nullptr)) {
+            fmt::print(stderr, "JSON schema violation: a record lacks \"{}\" "
+                               "or \"{}\"\n",
+                       keys.location, keys.country_code);
+            return false;
+        }
+        auto const code = intern_alpha_2(string_member(keys.country_code));
+        // filter by country if given, before anything is converted
+        if (country_code_ != 0 && code != country_code_) {
+            continue;
+        }
+
+        covid_data page{};
+        copy_name(string_member(keys.location), page.name);
+        page.code = code;
+        page.confirmed = count_member(keys.confirmed);
+        page.dead = count_member(keys.dead);
+        page.recovered = count_member(keys.recovered);
+
+        page.updated = parse_timestamp(string_member(keys.updated));
+        latest_update = std::max(latest_update, page.updated);
+        pages.push_back(page);
+    }
+    return true;
+}
+
+bool data_source::parse_sax(io::menu::pages_type &pages,
+                            std::int64_t &latest_update) {
+    using namespace rapidjson;
+
+    document_handler_.reset();
+    net::chunk_list::reader stream{body_};
+    // numbers are handed over unconverted, only the counts are converted
+    constexpr auto flags = kParseNumbersAsStringsFlag;
+    ParseResult ok{};
+    if (validate_) {
+        // validated while parsing, the handler only sees valid values
+        sax_validator_->Reset();
+        ok = sax_reader_.Parse<flags>(stream, *sax_validator_);
+        if (!sax_validator_->IsValid()) {
+            json::validator::print_error(*sax_validator_);
+            return false;
+        }
+    } else {
+        ok = sax_reader_.Parse<flags>(stream, document_handler_);
+    }
+    if (!ok) {
+        fmt::print(stderr, "JSON parse error: {} ({})\n",
+                   GetParseError_En(ok.Code()), ok.Offset());
+        return false;
+    }
+    if (!document_handler_.complete()) {
+        fmt::print(stderr, "JSON parse error: no \"{}\" array ({})\n",
+                   provider_.schema.records, provider_.name);
+        return false;
+    }
+    pages = std::move(document_handler_.pages());
+    latest_update = document_handler_.latest_update();
+    return true;
+}
@@ -0,0 +1,136 @@
+#include <include/history.h>
+#include <include/utils.h>
+
+#include <algorithm>
+
+history::history(size_type max_bytes, size_type depth)
+    : depth_(std::min<size_type>(depth, UINT32_MAX)) {
+    if (depth_ == 0) {
+        return;
+    }
+    // every location costs its ring, its name and code, the ring position
+    // and at most 4 slots of the lookup table, which is kept at most half
+    // full
+    capacity_ = std::min<size_type>(
+        max_bytes / (depth_ * sizeof(sample) + LOCATION_OVERHEAD),
+        NOT_FOUND / 2);
+    if (capacity_ == 0) {
+        return;
+    }
+    size_type table_size{1};
+    while (table_size < 2 * capacity_) {
+        table_size *= 2;
+    }
+    names_.reserve(capacity_);
+    codes_.reserve(capacity_);
+    table_.resize(table_size);
+    samples_.resize(capacity_ * depth_);
+    heads_.resize(capacity_);
+    counts_.resize(capacity_);
+}
+
+history::sample history::to_sample(io::menu::page_type const &page,
+                                   std::int64_t now) noexcept {
+    return {page.updated() != 0 ? page.updated() : now, page.confirmed(),
+            page.dead(), page.recovered()};
+}
+
+void history::record(io::menu::pages_type const &pages,
+                     std::int64_t now) noexcept {
+    if (capacity_ == 0) {
+        return;
+    }
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+        auto const page = pages[i];
+        auto const value = to_sample(page, now);
+        auto const id = find(page.code(), page.name());
+        if (id != NOT_FOUND && counts_[id] > 0) {
+            // the record did not change since the last refresh
+            auto const &last = at(id, counts_[id] - 1);
+            if (page.updated() != 0 ? last.time == value.time
+                                    : last.confirmed == value.confirmed &&
+                                          last.dead == value.dead &&
+                                          last.recovered == value.recovered) {
+                continue;
+            }
+        }
+        static_cast<void>(append(page.code(), page.name(), value));
+    }
+}
+
+bool history::append(std::uint16_t code, std::string_view name,
+                     sample const &value) noexcept {
+    if (capacity_ == 0) {
+        return false;
+    }
+    auto const index = slot(code, name);
+    auto id = table_[index];
+    if (id == 0) {
+        // a new location, interned if there is a ring left
+        if (codes_.size() == capacity_) {
+            return false;
+        }
+        auto &stored = names_.emplace_back();
+        auto const size = std::min(name.size(), stored.size() - 1);
+        std::copy_n(std::begin(name), size, std::begin(stored));
+        codes_.push_back(code);
+        id = table_[index] = static_cast<id_type>(codes_.size());
+    }
+    --id;
+    samples_[id * depth_ + heads_[id]] = value;
+    heads_[id] = static_cast<std::uint32_t>((heads_[id] + 1) % depth_);
+    counts_[id] = std::min<std::uint32_t>(counts_[id] + 1,
+                                          static_cast<std::uint32_t>(depth_));
+    return true;
+}
+
+history::id_type history::find(std::uint16_t code,
+                               std::string_view name) const noexcept {
+    if (capacity_ == 0) {
+        return NOT_FOUND;
+    }
+    auto const id = table_[slot(code, name)];
+    return id != 0 ? id - 1 : NOT_FOUND;
+}
+
+history::size_type history::count(id_type id) const noexcept {
+    return counts_[id];
+}
+
+history::sample const &history::at(id_type id,
+                                   size_type index) const noexcept {
+    // the oldest sample is the one to be overwritten next once the ring is
+    // full
+    auto const first = counts_[id] == depth_ ? heads_[id] : 0;
+    return samples_[id * depth_ + (first + index) % depth_];
+}
+
+history::size_type history::locations() const noexcept {
+    return codes_.size();
+}
+
+history::size_type history::capacity() const noexcept {
+    return capacity_;
+}
+
+history::size_type history::depth() const noexcept {
+    return depth_;
+}
+
+history::size_type history::slot(std::uint16_t code,
+                                 std::string_view name) const noexcept {
+    // names are truncated when interned, just like by utils::copy_name()
+    name = name.substr(0, MAX_COUNTRY_NAME_LEN);
+    auto const mask = table_.size() - 1;
+    auto index =
+        static_cast<size_type>(utils::location_hash(code, name)) & mask;
+    // linear probing, the table is never more than half full
+    for (;;) {
+        auto const id = table_[index];
+        if (id == 0 || (codes_[id - 1] == code &&
+                        std::string_view{names_[id - 1].data()} == name)) {
+            return index;
+        }
+        index = (index + 1) & mask;
+    }
+}
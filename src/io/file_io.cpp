@@ -0,0 +1,23 @@
+#include <include/io/file_io.h>
+
+#include <cerrno>
+
+#include <unistd.h>
+
+namespace io {
+    bool write_all(int fd, void const *data, std::size_t size) noexcept {
+        auto const *ptr = static_cast<char const *>(data);
+        while (size > 0) {
+            auto const written = ::write(fd, ptr, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            ptr += written;
+            size -= static_cast<std::size_t>(written);
+        }
+        return true;
+    }
+} // namespace io
@@ -0,0 +1,444 @@
+#include <include/io/file_io.h>
+#include <include/io/history_file.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace io {
+    static_assert(sizeof(history_file::index_entry) == 32,
+                  "index entries must not contain padding");
+
+    /**
+     *  A location while decoding a segment, its name refers to the mapped
+     *  history file.
+     */
+    struct decoded_location final {
+        std::uint16_t code;
+        std::string_view name;
+        history::sample last;
+    };
+
+    /**
+     *  A read-only mapping of a part of a file.
+     */
+    class file_mapping final {
+      public:
+        /**
+         *  @brief  Maps the bytes [offset, offset + size) of a file.
+         */
+        file_mapping(int fd, std::uint64_t offset, std::size_t size) noexcept {
+            if (size == 0) {
+                return;
+            }
+            // the offset of a mapping must be a multiple of the page size
+            auto const page_size =
+                static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+            auto const aligned = offset / page_size * page_size;
+            size_ = size + static_cast<std::size_t>(offset - aligned);
+            map_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd,
+                          static_cast<off_t>(aligned));
+            if (map_ == MAP_FAILED) {
+                map_ = nullptr;
+                return;
+            }
+            data_ = static_cast<char const *>(map_) + (offset - aligned);
+        }
+
+        file_mapping(file_mapping const &) = delete;
+        file_mapping &operator=(file_mapping const &) = delete;
+
+        ~file_mapping() {
+            if (map_ != nullptr) {
+                ::munmap(map_, size_);
+            }
+        }
+
+        /**
+         *  @brief  Returns the first mapped byte, null if the mapping failed.
+         */
+        [[nodiscard]] char const *data() const noexcept {
+            return data_;
+        }
+
+      private:
+        void *map_{nullptr};
+        std::size_t size_{0};
+        char const *data_{nullptr};
+    };
+
+    /**
+     *  @brief  Maps a signed delta to an unsigned one, small magnitudes of
+     *          either sign become small numbers.
+     */
+    static constexpr std::uint64_t zigzag(std::int64_t value) noexcept {
+        return (static_cast<std::uint64_t>(value) << 1) ^
+               static_cast<std::uint64_t>(value >> 63);
+    }
+
+    static constexpr std::int64_t unzigzag(std::uint64_t value) noexcept {
+        return static_cast<std::int64_t>(value >> 1) ^
+               -static_cast<std::int64_t>(value & 1);
+    }
+
+    static_assert(unzigzag(zigzag(-1)) == -1 && zigzag(-1) == 1 &&
+                  zigzag(1) == 2 && unzigzag(zigzag(INT64_MIN)) == INT64_MIN);
+
+    /**
+     *  @brief  Appends a LEB128 varint, 7 bits per byte.
+     */
+    static void put_varint(std::string &out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /**
+     *  @brief  Reads a LEB128 varint.
+     *  @return False if the varint is truncated or too long.
+     */
+    static bool get_varint(char const *&ptr, char const *end,
+                           std::uint64_t &value) noexcept {
+        value = 0;
+        for (unsigned shift = 0; shift < 64 && ptr != end; shift += 7) {
+            auto const byte = static_cast<std::uint8_t>(*ptr++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     *  @brief  Decodes a block.
+     *  @param  data    The block.
+     *  @param  entry   The index entry of the block.
+     *  @param  segment The locations of the segment decoded so far.
+     *  @param  visit   Visits each sample, may be null.
+     *  @return False if the block is corrupted, otherwise true.
+     */
+    static bool decode_block(char const *data,
+                             history_file::index_entry const &entry,
+                             std::vector<decoded_location> &segment,
+                             history::visitor const *visit) {
+        auto const *ptr = data;
+        auto const *const end = data + entry.size;
+        for (std::uint32_t i = 0; i < entry.count; ++i) {
+            std::uint64_t tag{};
+            if (!get_varint(ptr, end, tag)) {
+                return false;
+            }
+            auto const id = tag >> 1;
+            history::sample base{entry.time, 0, 0, 0};
+            if ((tag & 1) != 0) {
+                // the first entry of the location within the segment
+                std::uint64_t code{};
+                std::uint64_t name_size{};
+                if (id != segment.size() || !get_varint(ptr, end, code) ||
+                    !get_varint(ptr, end, name_size) ||
+                    name_size > static_cast<std::uint64_t>(end - ptr)) {
+                    return false;
+                }
+                segment.push_back({static_cast<std::uint16_t>(code),
+                                   {ptr, static_cast<std::size_t>(name_size)},
+                                   base});
+                ptr += name_size;
+            } else if (id < segment.size()) {
+                base = segment[id].last;
+            } else {
+                return false;
+            }
+            std::array<std::uint64_t, 4> deltas{};
+            for (auto &&delta : deltas) {
+                if (!get_varint(ptr, end, delta)) {
+                    return false;
+                }
+            }
+            auto &location = segment[id];
+            location.last = {
+                base.time + unzigzag(deltas[0]),
+                static_cast<std::int32_t>(base.confirmed + unzigzag(deltas[1])),
+                static_cast<std::int32_t>(base.dead + unzigzag(deltas[2])),
+                static_cast<std::int32_t>(base.recovered +
+                                          unzigzag(deltas[3]))};
+            if (visit != nullptr) {
+                (*visit)(location.code, location.name, location.last);
+            }
+        }
+        return ptr == end;
+    }
+
+    history_file::~history_file() {
+        close();
+    }
+
+    bool history_file::open(std::string const &path, std::uint8_t api,
+                            std::string_view country) {
+        close();
+        path_ = path;
+        index_path_ = path + ".idx";
+        fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        index_fd_ =
+            ::open(index_path_.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd_ < 0 || index_fd_ < 0) {
+            std::fprintf(stderr, "Unable to open history %s: %s\n",
+                         path_.c_str(), std::strerror(errno));
+            close();
+            return false;
+        }
+
+        auto const expected = make_header<history_file>(api, country);
+        header h{};
+        if (::pread(fd_, &h, sizeof(h), 0) == sizeof(h) &&
+            h.magic == expected.magic && h.version == expected.version &&
+            h.api == expected.api && h.country == expected.country) {
+            return recover();
+        }
+        struct stat st {};
+        if (::fstat(fd_, &st) == 0 && st.st_size > 0) {
+            std::fprintf(stderr,
+                         "Replacing history %s of another version or dataset\n",
+                         path_.c_str());
+        }
+        if (::ftruncate(fd_, 0) != 0 || ::ftruncate(index_fd_, 0) != 0 ||
+            !write_all(fd_, &expected, sizeof(expected))) {
+            std::fprintf(stderr, "Unable to write history %s: %s\n",
+                         path_.c_str(), std::strerror(errno));
+            close();
+            return false;
+        }
+        size_ = sizeof(header);
+        return true;
+    }
+
+    bool history_file::is_open() const noexcept {
+        return fd_ >= 0;
+    }
+
+    void history_file::begin(std::int64_t time) noexcept {
+        // the index is searched by time, it must not go backwards
+        time_ = std::max(time, last_time_);
+        count_ = 0;
+        block_.clear();
+        if (blocks_ % SEGMENT_BLOCKS == 0) {
+            locations_.clear();
+        }
+    }
+
+    void history_file::add(std::uint16_t code, std::string_view name,
+                           history::sample const &value) {
+        if (fd_ < 0) {
+            return;
+        }
+        key_.assign(name).append(reinterpret_cast<char const *>(&code),
+                                 sizeof(code));
+        auto it = locations_.find(key_);
+        history::sample base{time_, 0, 0, 0};
+        if (it == std::end(locations_)) {
+            auto const id = static_cast<std::uint32_t>(locations_.size());
+            it = locations_.emplace(key_, location{id, base}).first;
+            put_varint(block_, (std::uint64_t{id} << 1) | 1);
+            put_varint(block_, code);
+            put_varint(block_, name.size());
+            block_.append(name);
+        } else {
+            base = it->second.last;
+            put_varint(block_, std::uint64_t{it->second.id} << 1);
+        }
+        put_varint(block_, zigzag(value.time - base.time));
+        put_varint(block_, zigzag(std::int64_t{value.confirmed} -
+                                  base.confirmed));
+        put_varint(block_, zigzag(std::int64_t{value.dead} - base.dead));
+        put_varint(block_,
+                   zigzag(std::int64_t{value.recovered} - base.recovered));
+        it->second.last = value;
+        ++count_;
+    }
+
+    bool history_file::commit() {
+        if (fd_ < 0 || count_ == 0) {
+            return true;
+        }
+        index_entry const entry{
+            size_, time_, static_cast<std::uint32_t>(block_.size()), count_,
+            utils::fnv1a(block_.data(), block_.size())};
+        // the block is written first, an index entry without its complete
+        // block is discarded when the files are opened again
+        if (!write_all(fd_, block_.data(), block_.size()) ||
+            !write_all(index_fd_, &entry, sizeof(entry))) {
+            std::fprintf(stderr, "Unable to write history %s: %s\n",
+                         path_.c_str(), std::strerror(errno));
+            // the encoder state is ahead of the file now
+            close();
+            return false;
+        }
+        size_ += block_.size();
+        ++blocks_;
+        last_time_ = time_;
+        count_ = 0;
+        block_.clear();
+        return true;
+    }
+
+    bool history_file::scan(std::int64_t from, std::int64_t to,
+                            history::visitor const &visit) const {
+        if (fd_ < 0) {
+            return false;
+        }
+        file_mapping const index_map{index_fd_, 0,
+                                     blocks_ * sizeof(index_entry)};
+        if (blocks_ > 0 && index_map.data() == nullptr) {
+            return false;
+        }
+        auto const *const first_entry =
+            reinterpret_cast<index_entry const *>(index_map.data());
+        auto const *const last_entry = first_entry + blocks_;
+        auto const time_less = [](index_entry const &entry,
+                                  std::int64_t time) {
+            return entry.time < time;
+        };
+        auto const *const first = std::lower_bound(first_entry, last_entry,
+                                                   from, time_less);
+        auto const *const last =
+            std::lower_bound(first, last_entry, to, time_less);
+        if (first == last) {
+            return true;
+        }
+        // decoding starts at the beginning of the segment
+        auto const first_block = static_cast<std::size_t>(first - first_entry);
+        auto const *const start =
+            first_entry + first_block / SEGMENT_BLOCKS * SEGMENT_BLOCKS;
+        auto const end_offset = (last - 1)->offset + (last - 1)->size;
+        file_mapping const map{
+            fd_, start->offset,
+            static_cast<std::size_t>(end_offset - start->offset)};
+        if (map.data() == nullptr) {
+            return false;
+        }
+
+        std::vector<decoded_location> segment{};
+        for (auto const *entry = start; entry != last; ++entry) {
+            auto const block = static_cast<std::size_t>(entry - first_entry);
+            if (block % SEGMENT_BLOCKS == 0) {
+                segment.clear();
+            }
+            if (!decode_block(map.data() + (entry->offset - start->offset),
+                              *entry, segment,
+                              entry >= first ? &visit : nullptr)) {
+                std::fprintf(stderr, "Corrupted history %s\n", path_.c_str());
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool history_file::recover() {
+        struct stat st {};
+        struct stat index_st {};
+        if (::fstat(fd_, &st) != 0 || ::fstat(index_fd_, &index_st) != 0) {
+            close();
+            return false;
+        }
+        auto const file_size = static_cast<std::uint64_t>(st.st_size);
+        auto const entries =
+            static_cast<std::uint64_t>(index_st.st_size) / sizeof(index_entry);
+        file_mapping const index_map{index_fd_, 0,
+                                     entries * sizeof(index_entry)};
+        auto const *const index =
+            reinterpret_cast<index_entry const *>(index_map.data());
+        if (entries > 0 && index == nullptr) {
+            close();
+            return false;
+        }
+
+        // the blocks must follow each other and lie within the file
+        std::uint64_t valid{0};
+        std::uint64_t end = sizeof(header);
+        for (; valid < entries; ++valid) {
+            auto const &entry = index[valid];
+            if (entry.offset != end || entry.size > file_size - end) {
+                break;
+            }
+            end += entry.size;
+        }
+
+        // only the last segment may have been written partially, its
+        // blocks are verified and decoded to continue the segment
+        std::vector<decoded_location> segment{};
+        auto const start = valid / SEGMENT_BLOCKS * SEGMENT_BLOCKS;
+        locations_.clear();
+        if (start < valid) {
+            auto const begin_offset = index[start].offset;
+            file_mapping const map{
+                fd_, begin_offset,
+                static_cast<std::size_t>(end - begin_offset)};
+            if (map.data() == nullptr) {
+                close();
+                return false;
+            }
+            for (auto i = start; i < valid; ++i) {
+                auto const &entry = index[i];
+                auto const *const data =
+                    map.data() + (entry.offset - begin_offset);
+                if (utils::fnv1a(data, entry.size) != entry.checksum) {
+                    valid = i;
+                    end = entry.offset;
+                    break;
+                }
+                // an intact block which cannot be decoded leaves the state
+                // of the segment undefined, the whole segment is dropped
+                if (!decode_block(data, entry, segment, nullptr)) {
+                    segment.clear();
+                    valid = start;
+                    end = index[start].offset;
+                    break;
+                }
+            }
+            for (std::uint32_t id = 0; id < segment.size(); ++id) {
+                auto const &decoded = segment[id];
+                key_.assign(decoded.name)
+                    .append(reinterpret_cast<char const *>(&decoded.code),
+                            sizeof(decoded.code));
+                locations_.emplace(key_, location{id, decoded.last});
+            }
+        }
+        if (valid != entries || end != file_size) {
+            std::fprintf(stderr, "Discarding incomplete blocks of history %s\n",
+                         path_.c_str());
+            if (::ftruncate(fd_, static_cast<off_t>(end)) != 0 ||
+                ::ftruncate(index_fd_,
+                            static_cast<off_t>(valid * sizeof(index_entry))) !=
+                    0) {
+                close();
+                return false;
+            }
+        }
+        size_ = end;
+        blocks_ = valid;
+        last_time_ = valid > 0 ? index[valid - 1].time : 0;
+        return true;
+    }
+
+    void history_file::close() noexcept {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        if (index_fd_ >= 0) {
+            ::close(index_fd_);
+        }
+        fd_ = index_fd_ = -1;
+        size_ = blocks_ = 0;
+        last_time_ = 0;
+        locations_.clear();
+    }
+} // namespace io
@@ -20,6 +20,12 @@ namespace io {
     }
 
     void input_handler::process_inputs_thread() {
+        // pressing both buttons toggles the mode once, until released
+        bool chord{false};
+        // a button pressed alone during the previous poll, it turns the page
+        // one debounce period late, so the first button of a chord does not
+        bool left_pending{false};
+        bool right_pending{false};
         for (;;) {
             // wait until main thread has data
             std::unique_lock<std::mutex> ul(menu_mutex_);
@@ -29,13 +35,26 @@ namespace io {
             if (stop_token_.load()) {
                 return;
             }
-            if (digitalRead(io::gpio_pins::BTN_LEFT) == HIGH) {
+            bool const left = digitalRead(io::gpio_pins::BTN_LEFT) == HIGH;
+            bool const right = digitalRead(io::gpio_pins::BTN_RIGHT) == HIGH;
+            if (left && right) {
+                if (!chord) {
+                    menu_.toggle_mode();
+                }
+                chord = true;
+            } else if (chord) {
+                // the other button is ignored until both are released
+                chord = left || right;
+            } else if (left_pending) {
+                // still held or released since, either way no chord
                 menu_.prev();
-                menu_.render();
-            } else if (digitalRead(io::gpio_pins::BTN_RIGHT) == HIGH) {
+            } else if (right_pending) {
                 menu_.next();
-                menu_.render();
             }
+            left_pending = left && !right && !chord;
+            right_pending = right && !left && !chord;
+            // a page turned by a button or published by a refresh
+            menu_.render();
             std::this_thread::sleep_for(DEBOUNCE_TIME);
         }
     }
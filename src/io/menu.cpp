@@ -6,60 +6,149 @@
 #include <fmt/core.h>
 
 namespace io {
-    void menu::add_menu(menu::pages_type &&pages) noexcept {
-        pages_ = std::move(pages);
-        render();
+    /**
+     *  @brief  Determines whether two records of the same location render
+     *          the same page. The timestamp tells whether the counts have
+     *          changed, unless the provider did not deliver one.
+     */
+    static bool same_page(menu::page_type const &lhs,
+                          covid_data const &rhs) noexcept {
+        if (lhs.name() != rhs.name.data() || lhs.code() != rhs.code) {
+            return false;
+        }
+        if (lhs.updated() != 0) {
+            return lhs.updated() == rhs.updated;
+        }
+        return lhs.confirmed() == rhs.confirmed && lhs.dead() == rhs.dead &&
+               lhs.recovered() == rhs.recovered;
+    }
+
+    void menu::add_menu(menu::pages_type &&pages) {
+        auto snapshot = std::make_shared<pages_type const>(std::move(pages));
+        std::atomic_store_explicit(&pages_, std::move(snapshot),
+                                   std::memory_order_release);
+    }
+
+    void menu::add_movers(menu::pages_type &&movers) {
+        auto snapshot = std::make_shared<pages_type const>(std::move(movers));
+        std::atomic_store_explicit(&movers_, std::move(snapshot),
+                                   std::memory_order_release);
+    }
+
+    void menu::toggle_mode() noexcept {
+        mode_.store(mode_.load() == MenuMode::Pages ? MenuMode::Movers
+                                                    : MenuMode::Pages);
+        index_.store(0);
     }
 
     void menu::render() noexcept {
-        auto *const page = current();
-        auto const &loc = page->name;
-        auto const &code = page->code;
-        auto const &confirmed = page->confirmed;
-        auto const &dead = page->dead;
-        auto const &recovered = page->recovered;
+        auto const mode = mode_.load();
+        auto const pages = snapshot(mode);
+        if (pages == nullptr || pages->empty()) {
+            if (mode == MenuMode::Movers && rendered_pages_ != nullptr) {
+                // nothing moved yet, or no refresh since the boot
+                rendered_pages_ = nullptr;
+                oled_display::clear_buffer();
+                oled_display::display(0, 0, "No movers yet");
+            }
+            return;
+        }
+        auto const index = current_index(*pages);
+        if (pages == rendered_pages_ && index == rendered_index_) {
+            return;
+        }
+        auto const page = (*pages)[index];
+        bool const refreshed = rendered_pages_ != nullptr &&
+                               mode == rendered_mode_ &&
+                               index == rendered_index_ &&
+                               pages->size() == rendered_pages_->size();
+        // keeps the snapshot alive until the next one has been rendered
+        rendered_pages_ = pages;
+        rendered_index_ = index;
+        rendered_mode_ = mode;
+        if (refreshed && same_page(page, rendered_)) {
+            return;
+        }
+        rendered_ = page.record();
+
+        // null terminated, see page_store::row::name()
+        auto const loc = page.name();
+        auto const code = utils::alpha_2_name(page.code());
+        auto const confirmed = page.confirmed();
+        auto const dead = page.dead();
+        auto const recovered = page.recovered();
 
         // 192 bytes should be enough
         std::array<char, 192> buffer{};
-        fmt::format_to_n(buffer.data(), buffer.size(),
-                         "Location: {}\n"
-                         "Code: {}\n"
-                         "Cases: {}\n"
-                         "Dead: {}\n"
-                         "Healed: {}",
-                         loc.data(), code.data(), confirmed, dead, recovered);
-        std::scoped_lock<std::mutex> lk(display_mutex_);
         oled_display::clear_buffer();
-        oled_display::write(0, MenuRow::ROW7, "Page: {}/{}", index_ + 1,
-                            size());
+        if (mode == MenuMode::Movers) {
+            // the counts are the deltas to the previous refresh
+            fmt::format_to_n(buffer.data(), buffer.size(),
+                             "Location: {}\n"
+                             "Code: {}\n"
+                             "Cases: {:+}\n"
+                             "Dead: {:+}\n"
+                             "Healed: {:+}",
+                             loc.data(), code.data(), confirmed, dead,
+                             recovered);
+            oled_display::write(0, MenuRow::ROW7, "Mover: {}/{}", index + 1,
+                                pages->size());
+        } else {
+            fmt::format_to_n(buffer.data(), buffer.size(),
+                             "Location: {}\n"
+                             "Code: {}\n"
+                             "Cases: {}\n"
+                             "Dead: {}\n"
+                             "Healed: {}",
+                             loc.data(), code.data(), confirmed, dead,
+                             recovered);
+            oled_display::write(0, MenuRow::ROW7, "Page: {}/{}", index + 1,
+                                pages->size());
+        }
         oled_display::display(0, 0, buffer.data());
     }
 
-    menu::pages_type const &menu::pages() const noexcept {
-        return pages_;
+    menu::snapshot_type menu::pages() const noexcept {
+        return std::atomic_load_explicit(&pages_, std::memory_order_acquire);
+    }
+
+    menu::snapshot_type menu::movers() const noexcept {
+        return std::atomic_load_explicit(&movers_, std::memory_order_acquire);
     }
 
-    menu::pages_type &menu::pages() noexcept {
-        return pages_;
+    MenuMode menu::mode() const noexcept {
+        return mode_.load();
     }
 
     void menu::prev() noexcept {
-        index_ == 0 ? (index_ = size() - 1) : (index_--);
+        auto const pages = snapshot(mode_.load());
+        if (pages == nullptr || pages->empty()) {
+            return;
+        }
+        auto const index = current_index(*pages);
+        index_.store(index == 0 ? pages->size() - 1 : index - 1);
     }
 
     void menu::next() noexcept {
-        index_ = (index_ + 1) % size();
+        auto const pages = snapshot(mode_.load());
+        if (pages == nullptr || pages->empty()) {
+            return;
+        }
+        index_.store((current_index(*pages) + 1) % pages->size());
     }
 
     menu::size_type menu::size() const noexcept {
-        return pages_.size();
+        auto const pages = snapshot(mode_.load());
+        return pages != nullptr ? pages->size() : 0;
     }
 
-    covid_data const *menu::current() const noexcept {
-        return pages_[index_].get();
+    menu::snapshot_type menu::snapshot(MenuMode mode) const noexcept {
+        return mode == MenuMode::Movers ? movers() : pages();
     }
 
-    covid_data *menu::current() noexcept {
-        return pages_[index_].get();
+    menu::size_type menu::current_index(
+        pages_type const &pages) const noexcept {
+        auto const index = index_.load();
+        return index < pages.size() ? index : 0;
     }
 } // namespace io
\ No newline at end of file
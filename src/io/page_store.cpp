@@ -0,0 +1,104 @@
+#include <include/io/page_store.h>
+
+#include <cstring>
+
+namespace io {
+    /**
+     *  @brief  Reorders a column.
+     *  @param  column  The column.
+     *  @param  order   The index of the element which goes to each position.
+     */
+    template <typename T>
+    static void permute_column(std::vector<T> &column,
+                               std::vector<std::uint32_t> const &order) {
+        std::vector<T> permuted{};
+        permuted.reserve(column.size());
+        for (auto const index : order) {
+            permuted.push_back(column[index]);
+        }
+        column.swap(permuted);
+    }
+
+    covid_data page_store::row::record() const noexcept {
+        // value-initialized, the padding is zeroed for the snapshot checksum
+        auto record = covid_data();
+        auto const loc = name();
+        std::memcpy(record.name.data(), loc.data(), loc.size());
+        record.code = code();
+        record.confirmed = confirmed();
+        record.dead = dead();
+        record.recovered = recovered();
+        record.updated = updated();
+        return record;
+    }
+
+    void page_store::clear() noexcept {
+        names_.clear();
+        name_offsets_.clear();
+        name_sizes_.clear();
+        codes_.clear();
+        confirmed_.clear();
+        dead_.clear();
+        recovered_.clear();
+        updated_.clear();
+    }
+
+    void page_store::reserve(size_type count) {
+        name_offsets_.reserve(count);
+        name_sizes_.reserve(count);
+        codes_.reserve(count);
+        confirmed_.reserve(count);
+        dead_.reserve(count);
+        recovered_.reserve(count);
+        updated_.reserve(count);
+    }
+
+    void page_store::push_back(covid_data const &record) {
+        auto const size = ::strnlen(record.name.data(), MAX_COUNTRY_NAME_LEN);
+        name_offsets_.push_back(static_cast<std::uint32_t>(names_.size()));
+        name_sizes_.push_back(static_cast<std::uint8_t>(size));
+        names_.append(record.name.data(), size).push_back('\0');
+        codes_.push_back(record.code);
+        confirmed_.push_back(record.confirmed);
+        dead_.push_back(record.dead);
+        recovered_.push_back(record.recovered);
+        updated_.push_back(record.updated);
+    }
+
+    void page_store::append(page_store const &other) {
+        auto const base = static_cast<std::uint32_t>(names_.size());
+        names_.append(other.names_);
+        name_offsets_.reserve(size() + other.size());
+        for (auto const offset : other.name_offsets_) {
+            name_offsets_.push_back(base + offset);
+        }
+        auto const append_column = [](auto &to, auto const &from) {
+            to.insert(std::end(to), std::begin(from), std::end(from));
+        };
+        append_column(name_sizes_, other.name_sizes_);
+        append_column(codes_, other.codes_);
+        append_column(confirmed_, other.confirmed_);
+        append_column(dead_, other.dead_);
+        append_column(recovered_, other.recovered_);
+        append_column(updated_, other.updated_);
+    }
+
+    void page_store::set_counts(size_type index,
+                                covid_data const &record) noexcept {
+        confirmed_[index] = record.confirmed;
+        dead_[index] = record.dead;
+        recovered_[index] = record.recovered;
+        updated_[index] = record.updated;
+    }
+
+    void page_store::permute(std::vector<std::uint32_t> const &order) {
+        // the names stay where they are, only their offsets move
+        permute_column(name_offsets_, order);
+        permute_column(name_sizes_, order);
+        permute_column(codes_, order);
+        permute_column(confirmed_, order);
+        permute_column(dead_, order);
+        permute_column(recovered_, order);
+        permute_column(updated_, order);
+    }
+} // namespace io
@@ -0,0 +1,123 @@
+#include <include/io/file_io.h>
+#include <include/io/snapshot.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace io {
+    static_assert(std::is_trivially_copyable_v<covid_data>,
+                  "covid_data must be trivially copyable to be snapshotted");
+
+    /**
+     *  @brief  Fills in the format and dataset key of a snapshot header.
+     */
+    static snapshot::header make_snapshot_header(
+        std::uint8_t api, std::string_view country) noexcept {
+        auto h = make_header<snapshot>(api, country);
+        h.record_size = sizeof(covid_data);
+        return h;
+    }
+
+    bool snapshot::save(std::string const &path, std::uint8_t api,
+                        std::string_view country,
+                        menu::pages_type const &pages) noexcept {
+        auto h = make_snapshot_header(api, country);
+        h.count = static_cast<std::uint32_t>(pages.size());
+        h.checksum = utils::FNV_OFFSET_BASIS;
+        for (std::size_t i = 0; i < pages.size(); ++i) {
+            auto const record = pages[i].record();
+            h.checksum = utils::fnv1a(reinterpret_cast<char const *>(&record),
+                                      sizeof(covid_data), h.checksum);
+        }
+
+        auto const tmp_path = path + ".tmp";
+        int const fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                              0644);
+        if (fd < 0) {
+            std::fprintf(stderr, "Unable to write snapshot %s: %s\n",
+                         tmp_path.c_str(), std::strerror(errno));
+            return false;
+        }
+        bool ok = write_all(fd, &h, sizeof(h));
+        for (std::size_t i = 0; ok && i < pages.size(); ++i) {
+            auto const record = pages[i].record();
+            ok = write_all(fd, &record, sizeof(covid_data));
+        }
+        ok = ok && ::fsync(fd) == 0;
+        ok = ::close(fd) == 0 && ok;
+        ok = ok && std::rename(tmp_path.c_str(), path.c_str()) == 0;
+        if (!ok) {
+            std::fprintf(stderr, "Unable to write snapshot %s: %s\n",
+                         path.c_str(), std::strerror(errno));
+            ::unlink(tmp_path.c_str());
+        }
+        return ok;
+    }
+
+    bool snapshot::load(std::string const &path, std::uint8_t api,
+                        std::string_view country, menu::pages_type &pages) {
+        int const fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            // no snapshot yet on the very first boot
+            if (errno != ENOENT) {
+                std::fprintf(stderr, "Unable to read snapshot %s: %s\n",
+                             path.c_str(), std::strerror(errno));
+            }
+            return false;
+        }
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 ||
+            static_cast<std::size_t>(st.st_size) < sizeof(header)) {
+            ::close(fd);
+            return false;
+        }
+        auto const size = static_cast<std::size_t>(st.st_size);
+        void *const map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) {
+            std::fprintf(stderr, "Unable to map snapshot %s: %s\n",
+                         path.c_str(), std::strerror(errno));
+            return false;
+        }
+
+        auto const *const base = static_cast<char const *>(map);
+        header h{};
+        std::memcpy(&h, base, sizeof(h));
+        auto const expected = make_snapshot_header(api, country);
+        auto const *const records = base + sizeof(header);
+        bool ok = h.magic == expected.magic && h.version == expected.version &&
+                  h.record_size == expected.record_size &&
+                  h.api == expected.api && h.country == expected.country &&
+                  // checked before multiplying, a corrupt count must not
+                  // wrap around the 32-bit size_t of the Pi
+                  h.count <= (size - sizeof(header)) / sizeof(covid_data) &&
+                  size == sizeof(header) + h.count * sizeof(covid_data) &&
+                  h.checksum ==
+                      utils::fnv1a(records, h.count * sizeof(covid_data));
+        if (ok) {
+            pages.clear();
+            pages.reserve(h.count);
+            for (std::uint32_t i = 0; i < h.count; ++i) {
+                covid_data record{};
+                std::memcpy(&record, records + i * sizeof(covid_data),
+                            sizeof(covid_data));
+                pages.push_back(record);
+            }
+        } else {
+            std::fprintf(stderr,
+                         "Ignoring snapshot %s of another version or dataset\n",
+                         path.c_str());
+        }
+        ::munmap(map, size);
+        return ok;
+    }
+} // namespace io
@@ -0,0 +1,30 @@
+#include <include/io/status_leds.h>
+#include <include/utils.h>
+
+#include <wiringPi.h>
+
+namespace io {
+    static std::chrono::steady_clock::time_point last_toggle{};
+    static bool toggle{false};
+
+    void status_leds::tick() noexcept {
+        auto const now = std::chrono::steady_clock::now();
+        if (now - last_toggle < BLINK_INTERVAL) {
+            return;
+        }
+        last_toggle = now;
+        toggle = !toggle;
+        if (toggle) {
+            digitalWrite(io::gpio_pins::LED_GREEN, HIGH);
+            digitalWrite(io::gpio_pins::LED_RED, LOW);
+        } else {
+            digitalWrite(io::gpio_pins::LED_GREEN, LOW);
+            digitalWrite(io::gpio_pins::LED_RED, HIGH);
+        }
+    }
+
+    void status_leds::off() noexcept {
+        digitalWrite(io::gpio_pins::LED_GREEN, LOW);
+        digitalWrite(io::gpio_pins::LED_RED, LOW);
+    }
+} // namespace io
@@ -0,0 +1,57 @@
+#include <include/json/allocator.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace json {
+    void *counting_allocator::Malloc(std::size_t size) {
+        if (size == 0) {
+            return nullptr;
+        }
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        return std::malloc(size);
+    }
+
+    void *counting_allocator::Realloc(void *original, std::size_t,
+                                      std::size_t new_size) {
+        if (new_size == 0) {
+            std::free(original);
+            return nullptr;
+        }
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        return std::realloc(original, new_size);
+    }
+
+    void counting_allocator::Free(void *ptr) noexcept {
+        std::free(ptr);
+    }
+
+    std::uint64_t counting_allocator::allocations() noexcept {
+        return allocations_.load(std::memory_order_relaxed);
+    }
+
+    arena::arena(std::size_t size) : required_(size) {
+    }
+
+    arena::~arena() {
+        counting_allocator::Free(buffer_);
+    }
+
+    pool_allocator arena::allocator(counting_allocator &base) {
+        if (required_ > size_) {
+            counting_allocator::Free(buffer_);
+            // headroom for the chunk header and a slightly larger response
+            size_ = required_ + required_ / 4;
+            buffer_ = base.Malloc(size_);
+        }
+        return pool_allocator{buffer_, size_, CHUNK_CAPACITY, &base};
+    }
+
+    void arena::record(pool_allocator const &allocator) noexcept {
+        required_ = std::max(required_, allocator.Size());
+    }
+
+    std::size_t arena::size() const noexcept {
+        return size_;
+    }
+} // namespace json
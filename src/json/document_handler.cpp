@@ -0,0 +1,122 @@
+#include <include/json/document_handler.h>
+
+#include <algorithm>
+
+namespace json {
+    // depth of the top-level object, the records array and its records
+    static constexpr std::uint32_t ROOT_DEPTH = 1;
+    static constexpr std::uint32_t RECORDS_DEPTH = 2;
+    static constexpr std::uint32_t RECORD_DEPTH = 3;
+
+    document_handler::document_handler(std::string_view country,
+                                       schema const &keys) noexcept
+        : record_(keys, country), records_key_(keys.records) {
+    }
+
+    void document_handler::reset() noexcept {
+        pages_.clear();
+        latest_update_ = 0;
+        depth_ = 0;
+        records_key_seen_ = false;
+        in_records_ = false;
+        in_record_ = false;
+        complete_ = false;
+    }
+
+    void document_handler::require_members(bool required) noexcept {
+        record_.require_members(required);
+    }
+
+    bool document_handler::complete() const noexcept {
+        return complete_;
+    }
+
+    io::menu::pages_type &document_handler::pages() noexcept {
+        return pages_;
+    }
+
+    std::int64_t document_handler::latest_update() const noexcept {
+        return latest_update_;
+    }
+
+    bool document_handler::Default() noexcept {
+        return in_record_ ? record_.Default() : true;
+    }
+
+    bool document_handler::RawNumber(char const *str, SizeType len,
+                                     bool copy) noexcept {
+        return in_record_ ? record_.RawNumber(str, len, copy) : true;
+    }
+
+    bool document_handler::String(char const *str, SizeType len, bool copy) {
+        return in_record_ ? record_.String(str, len, copy) : true;
+    }
+
+    bool document_handler::Key(char const *str, SizeType len, bool copy) {
+        if (in_record_) {
+            return record_.Key(str, len, copy);
+        }
+        if (depth_ == ROOT_DEPTH) {
+            records_key_seen_ = records_key_ == std::string_view{str, len};
+        }
+        return true;
+    }
+
+    bool document_handler::StartObject() {
+        if (in_record_) {
+            ++depth_;
+            return record_.StartObject();
+        }
+        if (++depth_ == RECORD_DEPTH && in_records_) {
+            data_ = covid_data{};
+            record_.reset(data_);
+            in_record_ = true;
+            return record_.StartObject();
+        }
+        return true;
+    }
+
+    bool document_handler::EndObject(SizeType member_count) {
+        if (!in_record_) {
+            --depth_;
+            return true;
+        }
+        if (!record_.EndObject(member_count)) {
+            return false;
+        }
+        if (depth_-- != RECORD_DEPTH) {
+            return true;
+        }
+        in_record_ = false;
+        // filter by country if given
+        if (!record_.accepted()) {
+            return true;
+        }
+        latest_update_ = std::max(latest_update_, data_.updated);
+        pages_.push_back(data_);
+        return true;
+    }
+
+    bool document_handler::StartArray() noexcept {
+        if (in_record_) {
+            ++depth_;
+            return record_.StartArray();
+        }
+        if (++depth_ == RECORDS_DEPTH && records_key_seen_) {
+            in_records_ = true;
+        }
+        return true;
+    }
+
+    bool document_handler::EndArray(SizeType element_count) {
+        if (in_record_) {
+            --depth_;
+            return record_.EndArray(element_count);
+        }
+        if (depth_-- == RECORDS_DEPTH && in_records_) {
+            in_records_ = false;
+            complete_ = true;
+        }
+        return true;
+    }
+} // namespace json
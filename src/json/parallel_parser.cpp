@@ -0,0 +1,181 @@
+#include <include/json/parallel_parser.h>
+
+#include <algorithm>
+
+#include <fmt/core.h>
+
+namespace json {
+    // depth of the top-level object, the records array and its records
+    static constexpr std::uint32_t ROOT_DEPTH = 1;
+    static constexpr std::uint32_t DATA_DEPTH = 2;
+    static constexpr std::uint32_t RECORD_DEPTH = 3;
+
+    /**
+     * @brief   Finds the next character within a string which the scanner
+     *          has to look at, i.e. a quote or a backslash.
+     * @param   first   The first character to look at.
+     * @param   last    The end of the data.
+     * @return  The character or last if there is none.
+     */
+    static char const *find_string_special(char const *first,
+                                           char const *last) noexcept {
+        return std::find_if(first, last,
+                            [](char c) { return c == '"' || c == '\\'; });
+    }
+
+    parallel_parser::parallel_parser(std::string_view country,
+                                     schema const &keys,
+                                     worker_pool &workers) noexcept
+        : country_(country), keys_(keys), workers_(workers) {
+    }
+
+    void parallel_parser::set_validation(
+        schema_document const *record_schema) {
+        record_schema_ = record_schema;
+        for (auto &&parser : parsers_) {
+            parser->set_validation(record_schema_);
+        }
+    }
+
+    bool parallel_parser::parse(net::chunk_list const &body) {
+        pages_.clear();
+        latest_update_ = 0;
+        if (!split(body)) {
+            return false;
+        }
+        while (parsers_.size() < slices_.size()) {
+            parsers_.emplace_back(
+                std::make_unique<stream_parser>(country_, keys_));
+            parsers_.back()->set_validation(record_schema_);
+        }
+
+        results_.assign(slices_.size(), false);
+        auto parse_slice = [this, &body](std::size_t index) {
+            auto &parser = *parsers_[index];
+            parser.reset_records();
+            results_[index] = body.for_each_piece(
+                slices_[index].begin, slices_[index].end,
+                [&parser](char const *data, std::size_t size) {
+                    return parser.feed(data, size);
+                });
+        };
+        workers_.run(slices_.size(), parse_slice);
+        if (std::find(std::begin(results_), std::end(results_), false) !=
+            std::end(results_)) {
+            return false;
+        }
+
+        std::size_t records{0};
+        for (std::size_t i = 0; i < slices_.size(); ++i) {
+            records += parsers_[i]->pages().size();
+        }
+        pages_.reserve(records);
+        for (std::size_t i = 0; i < slices_.size(); ++i) {
+            auto &pages = parsers_[i]->pages();
+            pages_.append(pages);
+            pages.clear();
+            latest_update_ =
+                std::max(latest_update_, parsers_[i]->latest_update());
+        }
+        return true;
+    }
+
+    io::menu::pages_type &parallel_parser::pages() noexcept {
+        return pages_;
+    }
+
+    std::int64_t parallel_parser::latest_update() const noexcept {
+        return latest_update_;
+    }
+
+    bool parallel_parser::split(net::chunk_list const &body) {
+        slices_.clear();
+        key_.clear();
+        auto const workers = workers_.size();
+        auto const slice_size =
+            std::max(body.size() / workers, MIN_SLICE_SIZE);
+
+        std::size_t offset{0};
+        std::size_t slice_begin{0};
+        std::uint32_t depth{0};
+        bool in_string{false};
+        bool escape{false};
+        bool in_data{false};
+        bool seen_data{false};
+        auto const scan = [&](char const *data, std::size_t size) {
+            for (std::size_t i = 0; i < size; ++i) {
+                if (in_string) {
+                    if (escape) {
+                        escape = false;
+                        continue;
+                    }
+                    // only the keys of the top-level object are of interest,
+                    // any other string is skipped up to its end
+                    if (depth != ROOT_DEPTH) {
+                        i = static_cast<std::size_t>(
+                            find_string_special(data + i, data + size) - data);
+                        if (i == size) {
+                            break;
+                        }
+                    }
+                    auto const c = data[i];
+                    if (c == '\\') {
+                        escape = true;
+                    } else if (c == '"') {
+                        in_string = false;
+                    } else if (key_.size() <= keys_.records.size()) {
+                        key_.push_back(c);
+                    }
+                    continue;
+                }
+                switch (data[i]) {
+                    case '"':
+                        in_string = true;
+                        if (depth == ROOT_DEPTH) {
+                            key_.clear();
+                        }
+                        break;
+                    case '{':
+                    case '[':
+                        if (++depth == DATA_DEPTH && data[i] == '[' &&
+                            key_ == keys_.records && !seen_data) {
+                            in_data = seen_data = true;
+                            slice_begin = offset + i + 1;
+                        }
+                        break;
+                    case '}':
+                    case ']':
+                        if (depth == 0) {
+                            fmt::print(stderr,
+                                       "JSON parse error: unbalanced {}\n",
+                                       data[i]);
+                            return false;
+                        }
+                        if (in_data && depth == RECORD_DEPTH &&
+                            offset + i + 1 - slice_begin >= slice_size &&
+                            slices_.size() + 1 < workers) {
+                            slices_.push_back({slice_begin, offset + i + 1});
+                            slice_begin = offset + i + 1;
+                        } else if (in_data && depth == DATA_DEPTH) {
+                            slices_.push_back({slice_begin, offset + i});
+                            in_data = false;
+                        }
+                        --depth;
+                        break;
+                    default:
+                        break;
+                }
+            }
+            offset += size;
+            return true;
+        };
+        if (!body.for_each_piece(0, body.size(), scan)) {
+            return false;
+        }
+        if (!seen_data || in_data || depth != 0 || in_string) {
+            fmt::print(stderr, "JSON parse error: incomplete document\n");
+            return false;
+        }
+        return true;
+    }
+} // namespace json
@@ -0,0 +1,169 @@
+#include <include/json/record_handler.h>
+#include <include/utils.h>
+
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <string_view>
+
+#include <fmt/core.h>
+
+namespace json {
+    /**
+     * @brief   Converts a raw count of a record.
+     * @param   raw The number as it appears in the document.
+     * @return  The count, 0 for fractions, exponents and out of range values.
+     */
+    static std::int32_t to_count(std::string_view raw) noexcept {
+        std::int32_t value{};
+        auto const *const end = raw.data() + raw.size();
+        auto const [last, ec] = std::from_chars(raw.data(), end, value);
+        return ec == std::errc{} && last == end ? value : 0;
+    }
+
+    record_handler::record_handler(schema const &keys,
+                                   std::string_view country) noexcept
+        : keys_(make_key_table(keys)), location_key_(keys.location),
+          country_code_key_(keys.country_code),
+          country_(utils::intern_alpha_2(country)) {
+    }
+
+    void record_handler::reset(covid_data &target) noexcept {
+        data_ = &target;
+        location_ = {};
+        updated_ = {};
+        counts_ = {};
+        field_ = field::none;
+        depth_ = 0;
+        accepted_ = country_ == 0;
+        rejected_ = false;
+        has_location_ = false;
+        has_country_code_ = false;
+    }
+
+    bool record_handler::accepted() const noexcept {
+        return accepted_;
+    }
+
+    void record_handler::require_members(bool required) noexcept {
+        require_members_ = required;
+    }
+
+    bool record_handler::Default() noexcept {
+        // null and bool values keep the default of 0
+        field_ = field::none;
+        return true;
+    }
+
+    bool record_handler::RawNumber(char const *str, SizeType len,
+                                   bool copy) noexcept {
+        std::size_t index{COUNT_FIELDS};
+        switch (field_) {
+            case field::confirmed:
+                index = 0;
+                break;
+            case field::dead:
+                index = 1;
+                break;
+            case field::recovered:
+                index = 2;
+                break;
+            default:
+                break;
+        }
+        field_ = field::none;
+        // longer numbers are out of range and keep the default of 0
+        if (index == COUNT_FIELDS || len > MAX_COUNT_SIZE) {
+            return true;
+        }
+        counts_[index] = {str, len};
+        if (copy) {
+            auto &storage = count_storage_[index];
+            std::copy_n(str, len, std::begin(storage));
+            counts_[index] = {storage.data(), len};
+        }
+        return true;
+    }
+
+    bool record_handler::String(char const *str, SizeType len, bool copy) {
+        switch (field_) {
+            case field::location:
+                has_location_ = true;
+                location_ = {str, len};
+                if (copy) {
+                    location_ = location_storage_.assign(str, len);
+                }
+                break;
+            case field::country_code:
+                has_country_code_ = true;
+                data_->code = utils::intern_alpha_2({str, len});
+                if (country_ != 0) {
+                    accepted_ = data_->code == country_;
+                    rejected_ = !accepted_;
+                }
+                break;
+            case field::confirmed:
+            case field::dead:
+            case field::recovered:
+                // the schema validator hands raw numbers on as strings
+                return RawNumber(str, len, copy);
+            case field::updated:
+                updated_ = {str, len};
+                if (copy) {
+                    updated_ = updated_storage_.assign(str, len);
+                }
+                break;
+            default:
+                break;
+        }
+        field_ = field::none;
+        return true;
+    }
+
+    bool record_handler::Key(char const *str, SizeType len, bool) noexcept {
+        // only the members of the record itself are of interest
+        field_ = depth_ == 1 && !rejected_ ? find_field(keys_, {str, len})
+                                           : field::none;
+        return true;
+    }
+
+    bool record_handler::StartObject() noexcept {
+        assert(data_ && "record_handler::reset() was not called!");
+        field_ = field::none;
+        ++depth_;
+        return true;
+    }
+
+    bool record_handler::EndObject(SizeType) {
+        if (--depth_ != 0) {
+            return true;
+        }
+        // the members of a record of another country are skipped, it is
+        // dropped anyway
+        if (require_members_ && !rejected_ &&
+            (!has_location_ || !has_country_code_)) {
+            fmt::print(stderr, "JSON schema violation: a record lacks \"{}\"\n",
+                       has_location_ ? country_code_key_ : location_key_);
+            return false;
+        }
+        if (accepted_) {
+            utils::copy_name(location_, data_->name);
+            data_->confirmed = to_count(counts_[0]);
+            data_->dead = to_count(counts_[1]);
+            data_->recovered = to_count(counts_[2]);
+            data_->updated = utils::parse_timestamp(updated_);
+        }
+        return true;
+    }
+
+    bool record_handler::StartArray() noexcept {
+        field_ = field::none;
+        ++depth_;
+        return true;
+    }
+
+    bool record_handler::EndArray(SizeType) noexcept {
+        --depth_;
+        return true;
+    }
+} // namespace json
@@ -0,0 +1,171 @@
+#include <include/json/stream_parser.h>
+
+#include <algorithm>
+
+#include <rapidjson/error/en.h>
+
+#include <fmt/core.h>
+
+namespace json {
+    // depth of the top-level object, the records array and its records
+    static constexpr std::uint32_t ROOT_DEPTH = 1;
+    static constexpr std::uint32_t DATA_DEPTH = 2;
+    static constexpr std::uint32_t RECORD_DEPTH = 3;
+
+    stream_parser::stream_parser(std::string_view country,
+                                 schema const &keys) noexcept
+        : handler_(keys, country), records_key_(keys.records) {
+        record_.reserve(MAX_RECORD_SIZE);
+    }
+
+    void stream_parser::set_validation(schema_document const *record_schema) {
+        validator_.reset();
+        handler_.require_members(record_schema != nullptr);
+        if (record_schema != nullptr) {
+            validator_ = std::make_unique<schema_validator<record_handler>>(
+                *record_schema, handler_);
+        }
+    }
+
+    void stream_parser::reset() noexcept {
+        pages_.clear();
+        record_.clear();
+        key_.clear();
+        latest_update_ = 0;
+        depth_ = 0;
+        in_string_ = false;
+        escape_ = false;
+        in_data_ = false;
+        in_record_ = false;
+        seen_data_ = false;
+    }
+
+    void stream_parser::reset_records() noexcept {
+        reset();
+        depth_ = DATA_DEPTH;
+        in_data_ = seen_data_ = true;
+    }
+
+    bool stream_parser::feed(char const *data, std::size_t size) {
+        // start of the record within this chunk
+        std::size_t record_begin = 0;
+
+        for (std::size_t i = 0; i < size; ++i) {
+            auto const c = data[i];
+            if (in_string_) {
+                if (escape_) {
+                    escape_ = false;
+                } else if (c == '\\') {
+                    escape_ = true;
+                } else if (c == '"') {
+                    in_string_ = false;
+                } else if (depth_ == ROOT_DEPTH &&
+                           key_.size() <= records_key_.size()) {
+                    // one more character than the key of interest suffices
+                    // to tell a longer key apart
+                    key_.push_back(c);
+                }
+                continue;
+            }
+            switch (c) {
+                case '"':
+                    in_string_ = true;
+                    if (depth_ == ROOT_DEPTH) {
+                        key_.clear();
+                    }
+                    break;
+                case '[':
+                    if (++depth_ == DATA_DEPTH && key_ == records_key_) {
+                        in_data_ = seen_data_ = true;
+                    }
+                    break;
+                case '{':
+                    if (++depth_ == RECORD_DEPTH && in_data_) {
+                        in_record_ = true;
+                        record_begin = i;
+                        record_.clear();
+                    }
+                    break;
+                case ']':
+                case '}':
+                    if (depth_ == 0) {
+                        fmt::print(stderr, "JSON parse error: unbalanced {}\n",
+                                   c);
+                        return false;
+                    }
+                    if (depth_ == RECORD_DEPTH && in_record_) {
+                        record_.append(data + record_begin,
+                                       i + 1 - record_begin);
+                        in_record_ = false;
+                        if (!commit_record()) {
+                            return false;
+                        }
+                    } else if (depth_ == DATA_DEPTH) {
+                        in_data_ = false;
+                    }
+                    --depth_;
+                    break;
+                default:
+                    break;
+            }
+        }
+        // keep the unfinished record for the next chunk
+        if (in_record_) {
+            if (record_.size() + size - record_begin > MAX_RECORD_SIZE) {
+                fmt::print(stderr,
+                           "JSON parse error: record exceeds {} bytes\n",
+                           MAX_RECORD_SIZE);
+                return false;
+            }
+            record_.append(data + record_begin, size - record_begin);
+        }
+        return true;
+    }
+
+    bool stream_parser::finish() const noexcept {
+        return seen_data_ && depth_ == 0 && !in_string_;
+    }
+
+    io::menu::pages_type &stream_parser::pages() noexcept {
+        return pages_;
+    }
+
+    std::int64_t stream_parser::latest_update() const noexcept {
+        return latest_update_;
+    }
+
+    bool stream_parser::commit_record() {
+        using namespace rapidjson;
+
+        data_ = covid_data{};
+        handler_.reset(data_);
+        // the strings are parsed in place, the handler refers to them until
+        // the record has been committed
+        InsituStringStream ss{record_.data()};
+        constexpr auto flags = kParseInsituFlag | kParseNumbersAsStringsFlag;
+        ParseResult ok{};
+        if (validator_) {
+            validator_->Reset();
+            ok = reader_.Parse<flags>(ss, *validator_);
+            if (!validator_->IsValid()) {
+                validator::print_error(*validator_);
+                return false;
+            }
+        } else {
+            ok = reader_.Parse<flags>(ss, handler_);
+        }
+        if (!ok) {
+            fmt::print(stderr, "JSON parse error: {} ({})\n",
+                       GetParseError_En(ok.Code()), ok.Offset());
+            return false;
+        }
+
+        // filter by country if given
+        if (!handler_.accepted()) {
+            return true;
+        }
+        latest_update_ = std::max(latest_update_, data_.updated);
+        pages_.push_back(data_);
+        return true;
+    }
+} // namespace json
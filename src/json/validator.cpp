@@ -0,0 +1,70 @@
+#include <include/json/validator.h>
+
+#include <cassert>
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <fmt/format.h>
+
+namespace json {
+    /**
+     * @brief   Generates the schema of a record.
+     * @param   keys    The member names of the provider's response.
+     */
+    static std::string record_schema(schema const &keys) {
+        return fmt::format(
+            R"({{"type": "object", )"
+            R"("properties": {{"{0}": {{"type": "string"}}, )"
+            R"("{1}": {{"type": "string"}}, )"
+            R"("{2}": {{"type": ["string", "null"]}}}}}})",
+            keys.location, keys.country_code, keys.updated);
+    }
+
+    /**
+     * @brief   Generates the schema of a whole response.
+     * @param   keys    The member names of the provider's response.
+     */
+    static std::string document_schema(schema const &keys) {
+        return fmt::format(
+            R"({{"type": "object", )"
+            R"("properties": {{"{0}": {{"type": "array", "items": {1}}}}}}})",
+            keys.records, record_schema(keys));
+    }
+
+    /**
+     * @brief   Parses a generated schema.
+     */
+    static rapidjson::Document parse_schema(std::string const &text) {
+        rapidjson::Document d{};
+        d.Parse(text.c_str(), text.size());
+        assert(!d.HasParseError() && "generated schema is malformed!");
+        return d;
+    }
+
+    validator::validator(schema const &keys)
+        : document_(parse_schema(document_schema(keys))),
+          record_(parse_schema(record_schema(keys))) {
+    }
+
+    schema_document const &validator::document() const noexcept {
+        return document_;
+    }
+
+    schema_document const &validator::record() const noexcept {
+        return record_;
+    }
+
+    void validator::print_error(schema_document::PointerType const &pointer,
+                                char const *keyword) {
+        // rejected by the handler behind the validator, which reports why
+        if (keyword == nullptr) {
+            return;
+        }
+        rapidjson::StringBuffer buffer{};
+        pointer.StringifyUriFragment(buffer);
+        fmt::print(stderr, "JSON schema violation: {} violates \"{}\"\n",
+                   buffer.GetString(), keyword);
+    }
+} // namespace json
@@ -1,5 +1,6 @@
 #include <include/covid_status_handler.h>
 #include <include/io/oled_display.h>
+#include <include/refresh_scheduler.h>
 #include <include/utils.h>
 
 #include <cerrno>
@@ -8,6 +9,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <unistd.h>
+#include <vector>
 
 #include <cxxopts.hpp>
 #include <fmt/core.h>
@@ -17,12 +19,35 @@ using namespace std::literals::chrono_literals;
 int main(int argc, char *argv[]) {
     using namespace utils;
 
+    auto const startup_time = std::chrono::steady_clock::now();
+    auto const print_time_to_first_page = [&](std::string_view source) {
+        auto const elapsed = std::chrono::steady_clock::now() - startup_time;
+        fmt::print("time to first page: {}ms ({})\n",
+                   std::chrono::duration_cast<std::chrono::milliseconds>(
+                       elapsed)
+                       .count(),
+                   source);
+    };
+
     // default arguments
     APIType api_mode{APIType::Countries};
+    ParseMode parse_mode{ParseMode::Stream};
+    std::string snapshot_path{"covid-pi.snapshot"};
+    std::string url;
+    std::vector<std::string> mirrors;
+    std::int64_t max_recv_speed{0};
+    long chunk_size{0};
+    std::size_t max_body_size{0};
+    std::size_t history_memory{history::DEFAULT_MEMORY};
+    std::size_t history_depth{history::DEFAULT_DEPTH};
+    std::string history_path{"covid-pi.history"};
+    std::size_t movers_count{movers::DEFAULT_COUNT};
+    bool once{false};
+    bool validate{true};
     std::string country;
     covid_status_handler::SortFunction sort_fun =
         [](auto &&lhs, auto &&rhs) noexcept -> bool {
-        return lhs->confirmed > rhs->confirmed;
+        return lhs.confirmed() > rhs.confirmed();
     };
 
     // parse optional command line arguments
@@ -34,6 +59,19 @@ int main(int argc, char *argv[]) {
             ("h, help", "Print usage")
             ("c, cities", "Filter by country and show its cities", cxxopts::value<std::string>(), "alpha-2 code")
             ("s, sort", "Sort by confirmed cases.", cxxopts::value<std::string>(), "low / high")
+            ("p, parser", "JSON parsing mode.", cxxopts::value<std::string>(), "dom / sax / stream / parallel")
+            ("snapshot", "Snapshot file for an instant start (default: covid-pi.snapshot), empty to disable.", cxxopts::value<std::string>(), "path")
+            ("u, url", "Replay a recorded response, e.g. file:///tmp/cities.json, instead of querying the API.", cxxopts::value<std::string>(), "url")
+            ("mirror", "Additional provider with the same API, fetched in parallel and merged by location (repeatable).", cxxopts::value<std::vector<std::string>>(), "url")
+            ("throttle", "Limit the receive rate of HTTP transfers to emulate a slow connection.", cxxopts::value<std::int64_t>(), "bytes/s")
+            ("chunk-size", "Preferred size of the received chunks.", cxxopts::value<long>(), "bytes")
+            ("max-body-size", "Abort responses larger than this (default: 8MB).", cxxopts::value<std::size_t>(), "bytes")
+            ("history", "Memory ceiling of the per-location history (default: 4MB), 0 to disable.", cxxopts::value<std::size_t>(), "bytes")
+            ("history-file", "History file which keeps the history across reboots (default: covid-pi.history), empty to disable.", cxxopts::value<std::string>(), "path")
+            ("history-depth", "Samples kept per location (default: 512).", cxxopts::value<std::size_t>(), "count")
+            ("movers", "Locations listed in the movers mode, the ones which grew the most since the previous refresh (default: 10), 0 to disable.", cxxopts::value<std::size_t>(), "count")
+            ("no-validate", "Do not validate the responses against the schema of their provider.")
+            ("once", "Perform a single refresh, print its statistics and exit.")
         ;
         // clang-format on
         auto const result = options.parse(argc, argv);
@@ -57,11 +95,11 @@ int main(int argc, char *argv[]) {
             auto const order = result["sort"].as<std::string>();
             if (order == "low") {
                 sort_fun = [](auto &&lhs, auto &&rhs) noexcept -> bool {
-                    return lhs->confirmed < rhs->confirmed;
+                    return lhs.confirmed() < rhs.confirmed();
                 };
             } else if (order == "high") {
                 sort_fun = [](auto &&lhs, auto &&rhs) noexcept -> bool {
-                    return lhs->confirmed > rhs->confirmed;
+                    return lhs.confirmed() > rhs.confirmed();
                 };
             } else {
                 fmt::print(
@@ -70,6 +108,54 @@ int main(int argc, char *argv[]) {
                 return EXIT_SUCCESS;
             }
         }
+        if (result.count("parser")) {
+            auto const mode = result["parser"].as<std::string>();
+            if (mode == "dom") {
+                parse_mode = ParseMode::Dom;
+            } else if (mode == "sax") {
+                parse_mode = ParseMode::Sax;
+            } else if (mode == "stream") {
+                parse_mode = ParseMode::Stream;
+            } else if (mode == "parallel") {
+                parse_mode = ParseMode::Parallel;
+            } else {
+                fmt::print(stderr, "Invalid parsing mode. Available options: "
+                                   "dom, sax, stream, parallel\n");
+                return EXIT_SUCCESS;
+            }
+        }
+        if (result.count("snapshot")) {
+            snapshot_path = result["snapshot"].as<std::string>();
+        }
+        if (result.count("url")) {
+            url = result["url"].as<std::string>();
+        }
+        if (result.count("mirror")) {
+            mirrors = result["mirror"].as<std::vector<std::string>>();
+        }
+        if (result.count("throttle")) {
+            max_recv_speed = result["throttle"].as<std::int64_t>();
+        }
+        if (result.count("chunk-size")) {
+            chunk_size = result["chunk-size"].as<long>();
+        }
+        if (result.count("max-body-size")) {
+            max_body_size = result["max-body-size"].as<std::size_t>();
+        }
+        if (result.count("history")) {
+            history_memory = result["history"].as<std::size_t>();
+        }
+        if (result.count("history-file")) {
+            history_path = result["history-file"].as<std::string>();
+        }
+        if (result.count("history-depth")) {
+            history_depth = result["history-depth"].as<std::size_t>();
+        }
+        if (result.count("movers")) {
+            movers_count = result["movers"].as<std::size_t>();
+        }
+        validate = result.count("no-validate") == 0;
+        once = result.count("once") > 0;
     } catch (cxxopts::OptionException const &e) {
         fmt::print(stderr, "Error parsing options: {}\n", e.what());
         return EXIT_FAILURE;
@@ -105,9 +191,35 @@ int main(int argc, char *argv[]) {
     io::input_handler input_handler{menu};
     input_handler.start();
 
-    covid_status_handler status_handler{menu, input_handler, std::move(country),
+    net::fetcher fetcher{};
+    covid_status_handler status_handler{menu, input_handler, fetcher,
+                                        std::move(country),
                                         std::move(sort_fun)};
     status_handler.set_mode(api_mode);
+    if (!url.empty()) {
+        status_handler.set_url(url);
+    }
+    for (auto &&mirror : mirrors) {
+        auto source = providers::trackcorona(api_mode);
+        source.name = mirror;
+        source.url = std::move(mirror);
+        status_handler.add_provider(std::move(source));
+    }
+    if (max_recv_speed > 0) {
+        status_handler.set_max_recv_speed(max_recv_speed);
+    }
+    if (chunk_size > 0) {
+        status_handler.set_chunk_size(chunk_size);
+    }
+    if (max_body_size > 0) {
+        status_handler.set_max_body_size(max_body_size);
+    }
+    status_handler.set_parse_mode(parse_mode);
+    status_handler.set_validation(validate);
+    status_handler.set_history(history_memory, history_depth);
+    status_handler.set_history_path(std::move(history_path));
+    status_handler.set_movers(movers_count);
+    status_handler.set_snapshot_path(std::move(snapshot_path));
     if (!status_handler.setup()) {
         fmt::print(stderr, "curl setup failed!\n");
         return EXIT_FAILURE;
@@ -115,16 +227,64 @@ int main(int argc, char *argv[]) {
     // 60 seconds request timeout
     status_handler.set_timeout(60L);
 
-    constexpr auto next_request_time = 20min;
+    // show the pages of the previous run until the first refresh completes
+    static_cast<void>(status_handler.restore_history());
+    bool first_page_shown = status_handler.restore_snapshot();
+    if (first_page_shown) {
+        print_time_to_first_page("snapshot");
+    }
+
+    auto const print_stats = [&status_handler]() {
+        auto const &stats = status_handler.stats();
+        fmt::print("requests: {}, not modified: {}, unchanged: {}, "
+                   "reused connections: {}, received: {} bytes, "
+                   "saved: {} bytes\n",
+                   stats.requests, stats.not_modified, stats.unchanged,
+                   stats.reused_connections, stats.bytes_received,
+                   stats.bytes_saved);
+        auto const &t = stats.last_timings;
+        fmt::print("last transfer: {} / {} bytes (wire / decoded), "
+                   "dns: {}us, connect: {}us, tls: {}us, first byte: {}us, "
+                   "total: {}us\n",
+                   stats.last_bytes_on_wire, stats.last_bytes_decoded,
+                   t.dns.count(), t.connect.count(), t.tls.count(),
+                   t.first_byte.count(), t.total.count());
+        fmt::print("last refresh: parse: {}us ({} allocations), sort: {}us, "
+                   "publish: {}us\n",
+                   t.parse.count(), stats.last_parse_allocations,
+                   t.sort.count(), t.publish.count());
+    };
+
+    refresh_scheduler scheduler{};
     bool done{false};
+    bool ok{false};
     while (!done) {
-        // perform the async request
-        if (!status_handler.async_request()) {
-            fmt::print(stderr, "async_request() failed!\n");
-            done = true;
+        // perform the async request, retry with backoff on failure
+        ok = status_handler.async_request();
+        done = once;
+        if (!ok) {
+            if (done) {
+                fmt::print(stderr, "async_request() failed!\n");
+                break;
+            }
+            auto const retry = scheduler.on_failure();
+            fmt::print(stderr,
+                       "async_request() failed {} time(s), retrying in {}s\n",
+                       scheduler.failures(), retry.count());
+            std::this_thread::sleep_for(retry);
+            continue;
+        }
+        if (!first_page_shown) {
+            first_page_shown = true;
+            print_time_to_first_page("network");
+        }
+        print_stats();
+        if (done) {
             break;
         }
-        // perform next request after 20 minutes
+        auto const next_request_time = scheduler.on_success(
+            status_handler.data_changed(), status_handler.freshness());
+        fmt::print("next refresh in {}s\n", next_request_time.count());
         std::this_thread::sleep_for(next_request_time);
     }
 
@@ -139,5 +299,5 @@ int main(int argc, char *argv[]) {
 
     io::oled_display::cleanup();
 
-    return EXIT_SUCCESS;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
 }
@@ -0,0 +1,145 @@
+#include <include/movers.h>
+#include <include/utils.h>
+
+#include <algorithm>
+
+/**
+ * @brief   Determines whether a mover grew more than another one. Equal
+ *          growth is ranked by the sort order of the pages.
+ */
+template <typename Mover>
+static bool grew_more(Mover const &lhs, Mover const &rhs) noexcept {
+    return lhs.confirmed != rhs.confirmed ? lhs.confirmed > rhs.confirmed
+                                          : lhs.index < rhs.index;
+}
+
+movers::movers(size_type count) : count_(count) {
+    heap_.reserve(count_);
+}
+
+io::menu::pages_type movers::update(io::menu::pages_type const &previous,
+                                    io::menu::pages_type const &pages) {
+    deltas_.clear();
+    deltas_.reserve(pages.size());
+    heap_.clear();
+    index(previous);
+
+    for (std::size_t i = 0; i < pages.size(); ++i) {
+        auto const page = pages[i];
+        auto const prev = take(previous, page);
+        if (prev == NOT_FOUND) {
+            deltas_.push_back({0, 0, 0, true, true});
+            continue;
+        }
+        auto const last = previous[prev];
+        auto &value = deltas_.emplace_back(
+            delta{page.confirmed() - last.confirmed(),
+                  page.dead() - last.dead(),
+                  page.recovered() - last.recovered(), false,
+                  page.updated() != last.updated()});
+        value.changed = value.changed || value.confirmed != 0 ||
+                        value.dead != 0 || value.recovered != 0;
+        if (count_ == 0 || value.confirmed <= 0) {
+            continue;
+        }
+        // the front of the heap is the weakest mover, it is replaced by any
+        // candidate which grew more once the heap is full
+        mover const candidate{value.confirmed, static_cast<index_type>(i)};
+        if (heap_.size() < count_) {
+            heap_.push_back(candidate);
+            std::push_heap(std::begin(heap_), std::end(heap_),
+                           grew_more<mover>);
+        } else if (grew_more(candidate, heap_.front())) {
+            std::pop_heap(std::begin(heap_), std::end(heap_),
+                          grew_more<mover>);
+            heap_.back() = candidate;
+            std::push_heap(std::begin(heap_), std::end(heap_),
+                           grew_more<mover>);
+        }
+    }
+    std::sort_heap(std::begin(heap_), std::end(heap_), grew_more<mover>);
+
+    io::menu::pages_type top{};
+    top.reserve(heap_.size());
+    for (auto &&entry : heap_) {
+        auto record = pages[entry.index].record();
+        auto const &value = deltas_[entry.index];
+        record.confirmed = value.confirmed;
+        record.dead = value.dead;
+        record.recovered = value.recovered;
+        top.push_back(record);
+    }
+    return top;
+}
+
+std::vector<movers::delta> const &movers::deltas() const noexcept {
+    return deltas_;
+}
+
+movers::size_type movers::count() const noexcept {
+    return count_;
+}
+
+void movers::index(io::menu::pages_type const &previous) {
+    size_type table_size{1};
+    while (table_size < 2 * previous.size()) {
+        table_size *= 2;
+    }
+    // only grows, a smaller page set keeps the larger table
+    table_size = std::max(table_size, table_.size());
+    table_.assign(table_size, 0);
+    next_.resize(previous.size());
+    auto const mask = table_.size() - 1;
+
+    // inserted back to front, so the records of a location which is listed
+    // more than once are chained in their order
+    for (auto i = previous.size(); i-- > 0;) {
+        auto const page = previous[i];
+        auto slot = static_cast<size_type>(
+            utils::location_hash(page.code(), page.name())) & mask;
+        // linear probing, the table is never more than half full
+        for (;;) {
+            auto const id = table_[slot];
+            if (id == 0) {
+                next_[i] = 0;
+                break;
+            }
+            auto const other = previous[id - 1];
+            if (other.code() == page.code() && other.name() == page.name()) {
+                next_[i] = id;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+        table_[slot] = static_cast<index_type>(i + 1);
+    }
+    pending_ = table_;
+}
+
+movers::index_type movers::take(io::menu::pages_type const &previous,
+                                io::menu::page_type const &page) noexcept {
+    if (previous.empty()) {
+        return NOT_FOUND;
+    }
+    auto const mask = table_.size() - 1;
+    auto slot = static_cast<size_type>(
+        utils::location_hash(page.code(), page.name())) & mask;
+    for (;;) {
+        auto const id = table_[slot];
+        if (id == 0) {
+            return NOT_FOUND;
+        }
+        auto const other = previous[id - 1];
+        if (other.code() == page.code() && other.name() == page.name()) {
+            // the n-th record of a location is joined with its n-th
+            // previous record
+            auto const pending = pending_[slot];
+            if (pending == 0) {
+                return NOT_FOUND;
+            }
+            pending_[slot] = next_[pending - 1];
+            return pending - 1;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
@@ -0,0 +1,71 @@
+#include <include/net/chunk_list.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace net {
+    chunk_list::reader::reader(chunk_list const &list) noexcept
+        : list_(list) {
+        if (list_.size_ > 0) {
+            begin_ = pos_ = list_.chunks_.front()->data();
+            end_ = begin_ + std::min(list_.size_, CHUNK_SIZE);
+        }
+    }
+
+    void chunk_list::reader::next_chunk() noexcept {
+        offset_ += CHUNK_SIZE;
+        if (offset_ >= list_.size_) {
+            // keep pos_ == end_ to signal the end of the stream
+            begin_ = pos_ = end_;
+            offset_ = list_.size_;
+            return;
+        }
+        begin_ = pos_ = list_.chunks_[++index_]->data();
+        end_ = begin_ + std::min(list_.size_ - offset_, CHUNK_SIZE);
+    }
+
+    chunk_list::reader::Ch *chunk_list::reader::PutBegin() noexcept {
+        assert(false && "chunk_list::reader is read-only!");
+        return nullptr;
+    }
+
+    void chunk_list::reader::Put(Ch) noexcept {
+        assert(false && "chunk_list::reader is read-only!");
+    }
+
+    void chunk_list::reader::Flush() noexcept {
+        assert(false && "chunk_list::reader is read-only!");
+    }
+
+    std::size_t chunk_list::reader::PutEnd(Ch *) noexcept {
+        assert(false && "chunk_list::reader is read-only!");
+        return 0;
+    }
+
+    void chunk_list::clear() noexcept {
+        size_ = 0;
+    }
+
+    void chunk_list::append(char const *data, std::size_t size) {
+        while (size > 0) {
+            auto const offset = size_ % CHUNK_SIZE;
+            auto const index = size_ / CHUNK_SIZE;
+            if (index == chunks_.size()) {
+                chunks_.emplace_back(std::make_unique<chunk>());
+            }
+            auto const n = std::min(size, CHUNK_SIZE - offset);
+            std::copy_n(data, n, chunks_[index]->data() + offset);
+            data += n;
+            size -= n;
+            size_ += n;
+        }
+    }
+
+    std::size_t chunk_list::size() const noexcept {
+        return size_;
+    }
+
+    std::size_t chunk_list::capacity() const noexcept {
+        return chunks_.size() * CHUNK_SIZE;
+    }
+} // namespace net
@@ -0,0 +1,98 @@
+#include <include/net/fetcher.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <curl/curl.h>
+
+#include <fmt/core.h>
+
+namespace net {
+    fetcher::fetcher() {
+        curl_global_init(CURL_GLOBAL_ALL);
+        multi_ = curl_multi_init();
+        share_ = curl_share_init();
+        // all transfers run on the same thread, no lock callbacks required
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+
+    fetcher::~fetcher() {
+        for (auto const &transfer : transfers_) {
+            curl_multi_remove_handle(multi_, transfer.first);
+        }
+        curl_multi_cleanup(multi_);
+        curl_share_cleanup(share_);
+        curl_global_cleanup();
+    }
+
+    bool fetcher::add(CURL *handle, completion_handler &&on_done) {
+        assert(multi_ && "curl multi handle is NULL!\n");
+        curl_easy_setopt(handle, CURLOPT_SHARE, share_);
+        auto const res = curl_multi_add_handle(multi_, handle);
+        if (res != CURLM_OK) {
+            fmt::print(stderr, "curl_multi_add_handle() failed: {}\n",
+                       curl_multi_strerror(res));
+            return false;
+        }
+        transfers_.emplace_back(handle, std::move(on_done));
+        return true;
+    }
+
+    bool fetcher::run() {
+        using std::chrono::duration_cast;
+        using std::chrono::milliseconds;
+
+        int running{0};
+        while (!transfers_.empty()) {
+            auto res = curl_multi_perform(multi_, &running);
+            if (res == CURLM_OK) {
+                dispatch();
+                if (running > 0) {
+                    // sleep until there is activity on any of the sockets
+                    res = curl_multi_poll(
+                        multi_, nullptr, 0,
+                        duration_cast<milliseconds>(POLL_TIMEOUT).count(),
+                        nullptr);
+                }
+            }
+            if (res != CURLM_OK) {
+                fmt::print(stderr, "curl multi event loop failed: {}\n",
+                           curl_multi_strerror(res));
+                return false;
+            }
+        }
+        return true;
+    }
+
+    fetcher::size_type fetcher::pending() const noexcept {
+        return transfers_.size();
+    }
+
+    void fetcher::dispatch() {
+        int queued{0};
+        while (auto const *msg = curl_multi_info_read(multi_, &queued)) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+            auto *const handle = msg->easy_handle;
+            auto const res = msg->data.result;
+            curl_multi_remove_handle(multi_, handle);
+
+            auto const it = std::find_if(
+                std::begin(transfers_), std::end(transfers_),
+                [handle](auto &&transfer) { return transfer.first == handle; });
+            if (it == std::end(transfers_)) {
+                continue;
+            }
+            // the handler may queue new transfers
+            auto on_done = std::move(it->second);
+            transfers_.erase(it);
+            if (res != CURLE_OK) {
+                fmt::print(stderr, "transfer failed: {}\n",
+                           curl_easy_strerror(res));
+            }
+            on_done(res == CURLE_OK);
+        }
+    }
+} // namespace net
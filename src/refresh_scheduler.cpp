@@ -0,0 +1,35 @@
+#include <include/refresh_scheduler.h>
+
+#include <algorithm>
+
+refresh_scheduler::refresh_scheduler() : rng_(std::random_device{}()) {
+}
+
+refresh_scheduler::duration
+refresh_scheduler::on_success(bool data_changed, duration freshness) noexcept {
+    failures_ = 0;
+    // poll faster while the data keeps changing, back off while it doesn't
+    interval_ = data_changed ? interval_ * 3 / 4 : interval_ * 5 / 4;
+    interval_ = std::clamp(interval_, MIN_INTERVAL, MAX_INTERVAL);
+    // a request before the response went stale would only yield a 304
+    return std::clamp(freshness, interval_, MAX_INTERVAL);
+}
+
+refresh_scheduler::duration refresh_scheduler::on_failure() noexcept {
+    // limit the shift, MAX_BACKOFF is reached long before
+    auto const exponent = std::min<std::uint32_t>(failures_++, 16);
+    auto const backoff = std::min(MIN_BACKOFF * (1 << exponent), MAX_BACKOFF);
+    // equal jitter: wait at least half of the backoff so that a fleet of
+    // devices does not retry in lockstep after an outage
+    std::uniform_int_distribution<duration::rep> jitter{0,
+                                                        backoff.count() / 2};
+    return backoff / 2 + duration{jitter(rng_)};
+}
+
+refresh_scheduler::duration refresh_scheduler::interval() const noexcept {
+    return interval_;
+}
+
+std::uint32_t refresh_scheduler::failures() const noexcept {
+    return failures_;
+}
@@ -0,0 +1,66 @@
+#include <include/worker_pool.h>
+
+worker_pool::worker_pool(std::size_t threads) noexcept
+    : thread_count_(threads) {
+}
+
+worker_pool::~worker_pool() {
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &&thread : threads_) {
+        thread.join();
+    }
+}
+
+std::size_t worker_pool::size() const noexcept {
+    return thread_count_ + 1;
+}
+
+void worker_pool::run(std::size_t count, task_type task, void *context) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    // a single task is not worth waking up, or even starting, a thread
+    if (count > 1 && threads_.size() < thread_count_) {
+        threads_.reserve(thread_count_);
+        while (threads_.size() < thread_count_) {
+            threads_.emplace_back([this]() { work(); });
+        }
+    }
+    task_ = task;
+    context_ = context;
+    count_ = count;
+    next_ = 0;
+    pending_ = count;
+    if (count > 1) {
+        wake_.notify_all();
+    }
+    while (next_ < count_) {
+        auto const index = next_++;
+        lk.unlock();
+        task(context, index);
+        lk.lock();
+        --pending_;
+    }
+    done_.wait(lk, [this]() { return pending_ == 0; });
+}
+
+void worker_pool::work() {
+    std::unique_lock<std::mutex> lk(mutex_);
+    for (;;) {
+        wake_.wait(lk, [this]() { return stop_ || next_ < count_; });
+        if (stop_) {
+            return;
+        }
+        auto const index = next_++;
+        auto const task = task_;
+        auto const context = context_;
+        lk.unlock();
+        task(context, index);
+        lk.lock();
+        if (--pending_ == 0) {
+            done_.notify_one();
+        }
+    }
+}